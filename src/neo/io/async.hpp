@@ -0,0 +1,318 @@
+#pragma once
+
+#include <neo/io/completion_condition.hpp>
+#include <neo/io/concepts/read_stream.hpp>
+#include <neo/io/concepts/write_stream.hpp>
+#include <neo/io/reactor.hpp>
+
+#include <neo/assert.hpp>
+#include <neo/buffers_consumer.hpp>
+#include <neo/fwd.hpp>
+#include <neo/ref.hpp>
+
+#if __cpp_impl_coroutine >= 201902L
+#define NEO_IO_HAVE_COROUTINES 1
+#include <coroutine>
+#endif
+
+#include <system_error>
+#include <utility>
+
+namespace neo {
+
+namespace io_detail {
+
+/**
+ * An operation that is waiting for a stream to become ready. The readiness
+ * source calls `on_ready` once (and only once) for each time the operation is
+ * passed to `async_wait()`.
+ */
+struct readiness_op {
+    using callback_type = void (*)(readiness_op& self, io_readiness ready) noexcept;
+
+    callback_type on_ready = nullptr;
+
+    explicit constexpr readiness_op(callback_type cb) noexcept
+        : on_ready(cb) {}
+};
+
+}  // namespace io_detail
+
+// clang-format off
+/**
+ * A `readiness_source` can notify a waiting operation when a stream may be
+ * ready to read or write. Operations are always attempted before waiting, so
+ * spurious notifications are harmless.
+ */
+template <typename T>
+concept readiness_source =
+    requires(T& src, io_readiness interest, io_detail::readiness_op& op) {
+        src.async_wait(interest, op);
+    };
+
+template <typename T>
+concept async_read_stream = read_stream<T> && readiness_source<T>;
+
+template <typename T>
+concept async_write_stream = write_stream<T> && readiness_source<T>;
+// clang-format on
+
+/**
+ * @brief Adapt a non-blocking native stream (native_stream, socket, etc.) to
+ * act as a `readiness_source`, using a `reactor` to detect readiness.
+ *
+ * The stream is placed in non-blocking mode and registered with the reactor
+ * (edge-triggered) for as long as the async_stream exists. Registration occurs
+ * once, so individual operations do not allocate or make epoll_ctl() calls.
+ *
+ * At most one read and one write may be waiting at a time. The reactor must
+ * outlive the async_stream, and must not be moved while the stream is
+ * registered.
+ */
+template <typename Stream>
+class async_stream {
+    wrap_refs_t<Stream>      _strm;
+    reactor&                 _reactor;
+    io_detail::readiness_op* _read_op  = nullptr;
+    io_detail::readiness_op* _write_op = nullptr;
+
+    void _on_ready(io_readiness ready) noexcept {
+        auto is_set      = [&](io_readiness r) { return (ready & r) != io_readiness::none; };
+        auto wake_always = io_readiness::error | io_readiness::hangup;
+        // Take both operations before invoking either: The first may complete
+        // a coroutine that destroys this object.
+        auto rd = is_set(io_readiness::readable | wake_always) ? std::exchange(_read_op, nullptr)
+                                                               : nullptr;
+        auto wr = is_set(io_readiness::writable | wake_always) ? std::exchange(_write_op, nullptr)
+                                                               : nullptr;
+        if (rd) {
+            rd->on_ready(*rd, ready);
+        }
+        if (wr) {
+            wr->on_ready(*wr, ready);
+        }
+    }
+
+public:
+    /**
+     * @brief Register the stream with the given reactor. Throws on failure.
+     */
+    async_stream(reactor& r, Stream&& strm)
+        : _strm(NEO_FWD(strm))
+        , _reactor(r) {
+        auto& s = stream();
+        if constexpr (requires { s.set_nonblocking(true); }) {
+            s.set_nonblocking(true);
+        } else {
+            s.native().set_nonblocking(true);
+        }
+        _reactor.add(s,
+                     io_readiness::readable | io_readiness::writable
+                         | io_readiness::edge_triggered,
+                     [this](io_readiness ready) { _on_ready(ready); });
+    }
+
+    ~async_stream() {
+        std::error_code ec;
+        _reactor.remove(native_handle_of(stream()), ec);
+    }
+
+    async_stream(const async_stream&) = delete;
+    async_stream& operator=(const async_stream&) = delete;
+
+    NEO_DECL_UNREF_GETTER(stream, _strm);
+
+    /**
+     * @brief Arrange for `op` to be notified when the stream may be ready for
+     * the given operation (either io_readiness::readable or ::writable).
+     */
+    void async_wait(io_readiness interest, io_detail::readiness_op& op) noexcept {
+        if ((interest & io_readiness::readable) != io_readiness::none) {
+            neo_assert(expects, _read_op == nullptr, "Only one read may wait at a time");
+            _read_op = &op;
+        } else {
+            neo_assert(expects, _write_op == nullptr, "Only one write may wait at a time");
+            _write_op = &op;
+        }
+    }
+
+    template <buffer_range Bufs>
+    auto write_some(Bufs&& b) noexcept requires requires {
+        stream().write_some(b);
+    }
+    { return stream().write_some(b); }
+
+    template <mutable_buffer_range Bufs>
+    auto read_some(Bufs&& b) noexcept requires requires {
+        stream().read_some(b);
+    }
+    { return stream().read_some(b); }
+};
+
+template <typename Stream>
+async_stream(reactor&, Stream&&) -> async_stream<Stream>;
+
+#if NEO_IO_HAVE_COROUTINES
+
+namespace io_detail {
+
+template <bool IsRead, typename Stream, typename Part>
+auto do_io_some(Stream& strm, Part&& part) noexcept {
+    if constexpr (IsRead) {
+        return strm.read_some(part);
+    } else {
+        return strm.write_some(part);
+    }
+}
+
+/**
+ * The awaitable that implements all asynchronous reads and writes. This is the
+ * asynchronous analogue of `detail::do_io_op`.
+ *
+ * The operation is attempted immediately. If the stream would block, the
+ * coroutine is suspended and further progress is made within the readiness
+ * notifications. The coroutine is only resumed once the whole operation has
+ * completed. All state lives within the awaitable (and therefore within the
+ * coroutine frame), so no allocation is required.
+ */
+template <typename Stream, typename Bufs, typename Cond, bool IsRead, bool IsSingle>
+class async_io_op : readiness_op {
+    constexpr static bool use_buf_ranges
+        = IsRead ? vectored_read_stream<Stream> : vectored_write_stream<Stream>;
+    using consumer_type = std::conditional_t<use_buf_ranges,
+                                             buffers_consumer<std::remove_reference_t<Bufs>&>,
+                                             buffers_vec_consumer<std::remove_reference_t<Bufs>&>>;
+
+    Stream&                 _strm;
+    Bufs                    _bufs;
+    Cond                    _cond;
+    consumer_type           _consumer{_bufs};
+    std::coroutine_handle<> _waiter;
+
+    using result_type = decltype(do_io_some<IsRead>(std::declval<Stream&>(),
+                                                    std::declval<consumer_type&>().next(1)));
+    result_type _result;
+
+    /// Make as much progress as possible. Returns `true` once the operation is complete.
+    bool _advance() noexcept {
+        while (true) {
+            const std::size_t req_to_transfer = std::invoke(_cond, std::as_const(_result));
+            if (req_to_transfer == 0) {
+                return true;
+            }
+            auto part = _consumer.next(req_to_transfer);
+            if (buffer_is_empty(part)) {
+                return true;
+            }
+            auto res = do_io_some<IsRead>(_strm, part);
+            if (transfer_would_block(res) && res.bytes_transferred == 0) {
+                return false;
+            }
+            _result = sum_transfer_result(_result, res);
+            _consumer.consume(res.bytes_transferred);
+            if (IsSingle || transfer_errant(_result) || res.bytes_transferred == 0) {
+                return true;
+            }
+        }
+    }
+
+    void _wait() noexcept {
+        _strm.async_wait(IsRead ? io_readiness::readable : io_readiness::writable, *this);
+    }
+
+    static void _on_ready(readiness_op& self_, io_readiness) noexcept {
+        auto& self = static_cast<async_io_op&>(self_);
+        if (self._advance()) {
+            self._waiter.resume();
+        } else {
+            self._wait();
+        }
+    }
+
+public:
+    async_io_op(Stream& strm, Bufs&& bufs, Cond&& cond) noexcept
+        : readiness_op(&_on_ready)
+        , _strm(strm)
+        , _bufs(NEO_FWD(bufs))
+        , _cond(NEO_FWD(cond)) {
+        _result.bytes_transferred = 0;
+    }
+
+    // The readiness source refers to this object. It must never move.
+    async_io_op(const async_io_op&) = delete;
+    async_io_op& operator=(const async_io_op&) = delete;
+
+    bool await_ready() noexcept { return _advance(); }
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        _waiter = h;
+        _wait();
+    }
+    result_type await_resume() noexcept { return _result; }
+};
+
+}  // namespace io_detail
+
+/**
+ * @brief Asynchronously read some data from the stream into the given buffers.
+ *
+ * Returns an awaitable. The awaiting coroutine is suspended until data is
+ * available (or an error or EOF occurs).
+ */
+template <async_read_stream Stream, mutable_buffer_range Bufs>
+[[nodiscard]] auto async_read_some(Stream& strm, Bufs&& bufs) noexcept {
+    return io_detail::async_io_op<Stream, Bufs, transfer_all_t, true, true>{strm,
+                                                                           NEO_FWD(bufs),
+                                                                           transfer_all_t{}};
+}
+
+/**
+ * @brief Asynchronously write some data from the buffers into the stream.
+ */
+template <async_write_stream Stream, buffer_range Bufs>
+[[nodiscard]] auto async_write_some(Stream& strm, Bufs&& bufs) noexcept {
+    return io_detail::async_io_op<Stream, Bufs, transfer_all_t, false, true>{strm,
+                                                                            NEO_FWD(bufs),
+                                                                            transfer_all_t{}};
+}
+
+/**
+ * @brief Asynchronously read from the stream into the buffers until a
+ * completion condition is met. The semantics match those of `neo::read()`.
+ */
+template <async_read_stream                     Stream,
+          mutable_buffer_range                  Bufs,
+          read_completion_condition_for<Stream> CompletionCondition>
+[[nodiscard]] auto async_read(Stream& strm, Bufs&& bufs, CompletionCondition&& cond) noexcept {
+    return io_detail::async_io_op<Stream, Bufs, CompletionCondition, true, false>{
+        strm,
+        NEO_FWD(bufs),
+        NEO_FWD(cond)};
+}
+
+template <async_read_stream Stream, mutable_buffer_range Bufs>
+[[nodiscard]] auto async_read(Stream& strm, Bufs&& bufs) noexcept {
+    return async_read(strm, NEO_FWD(bufs), transfer_all);
+}
+
+/**
+ * @brief Asynchronously write the buffers into the stream until the completion
+ * condition is met. The semantics match those of `neo::write()`.
+ */
+template <async_write_stream                     Stream,
+          buffer_range                           Bufs,
+          write_completion_condition_for<Stream> CompletionCondition>
+[[nodiscard]] auto async_write(Stream& strm, Bufs&& bufs, CompletionCondition&& cond) noexcept {
+    return io_detail::async_io_op<Stream, Bufs, CompletionCondition, false, false>{
+        strm,
+        NEO_FWD(bufs),
+        NEO_FWD(cond)};
+}
+
+template <async_write_stream Stream, buffer_range Bufs>
+[[nodiscard]] auto async_write(Stream& strm, Bufs&& bufs) noexcept {
+    return async_write(strm, NEO_FWD(bufs), transfer_all);
+}
+
+#endif  // NEO_IO_HAVE_COROUTINES
+
+}  // namespace neo
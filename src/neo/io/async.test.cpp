@@ -0,0 +1,109 @@
+#include <neo/io/async.hpp>
+
+#include "../../../testing/pipe.hpp"
+
+#include <catch2/catch.hpp>
+
+#if __linux__ && NEO_IO_HAVE_COROUTINES
+
+#include <exception>
+#include <string>
+
+using neo::testing::make_pipe;
+
+namespace {
+
+/// A minimal eagerly-started, fire-and-forget coroutine type
+struct task {
+    struct promise_type {
+        task               get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void               return_void() noexcept {}
+        void               unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+}  // namespace
+
+TEST_CASE("Asynchronously read and write through a pipe") {
+    neo::reactor r;
+    auto [in, out] = make_pipe();
+    neo::async_stream ain{r, in};
+
+    std::string buf;
+    buf.resize(10);
+    bool                           done = false;
+    neo::native_stream_read_result result;
+    auto coro = [&]() -> task {
+        result = co_await neo::async_read(ain, neo::mutable_buffer(buf));
+        done   = true;
+    };
+    coro();
+    CHECK_FALSE(done);
+
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("Hell")).has_error());
+    r.run_once(std::chrono::milliseconds(100));
+    // We have not received everything yet
+    CHECK_FALSE(done);
+
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("o, pipe!")).has_error());
+    r.run_once(std::chrono::milliseconds(100));
+    REQUIRE(done);
+    CHECK_FALSE(result.has_error());
+    CHECK(result.bytes_transferred == 10);
+    CHECK(buf == "Hello, pip");
+
+    // The remaining data is available immediately, so there is no suspension
+    done = false;
+    buf.resize(2);
+    auto coro2 = [&]() -> task {
+        result = co_await neo::async_read_some(ain, neo::mutable_buffer(buf));
+        done   = true;
+    };
+    coro2();
+    CHECK(done);
+    CHECK(buf == "e!");
+}
+
+TEST_CASE("Asynchronously write more than a pipe can hold") {
+    neo::reactor r;
+    auto [in, out] = make_pipe();
+    neo::async_stream aout{r, out};
+    neo::async_stream ain{r, in};
+
+    std::string payload(1024 * 1024, 'x');
+    std::string got;
+    got.resize(payload.size());
+
+    bool wrote = false;
+    bool read  = false;
+    auto writer = [&]() -> task {
+        auto res = co_await neo::async_write(aout, neo::const_buffer(payload));
+        CHECK(res.bytes_transferred == payload.size());
+        wrote = true;
+    };
+    auto reader = [&]() -> task {
+        // Read in two halves, using a completion condition
+        auto half = got.size() / 2;
+        auto res  = co_await neo::async_read(ain,
+                                            neo::mutable_buffer(got),
+                                            neo::transfer_exactly{half});
+        CHECK(res.bytes_transferred == half);
+        auto rest = neo::mutable_buffer(got);
+        rest += half;
+        res = co_await neo::async_read(ain, rest);
+        CHECK(res.bytes_transferred == half);
+        read = true;
+    };
+    writer();
+    reader();
+    for (auto i = 0; i < 10000 && !(wrote && read); ++i) {
+        r.run_once(std::chrono::milliseconds(100));
+    }
+    CHECK(wrote);
+    CHECK(read);
+    CHECK(got == payload);
+}
+
+#endif
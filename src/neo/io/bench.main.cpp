@@ -0,0 +1,382 @@
+/**
+ * Throughput benchmarks for neo-io.
+ *
+ * Usage: bench [--min-time=<milliseconds>] [<filter> ...]
+ *
+ * Each benchmark prints one line of JSON to stdout, so that results can be
+ * collected and compared between versions:
+ *
+ *   {"benchmark":"roundtrip/pipe","buffer_size":4096,"fragments":16,
+ *    "iterations":131072,"ns_per_op":1805.3,"bytes_per_second":2268851200}
+ *
+ * `buffer_size` is the number of bytes moved by a single operation, split
+ * evenly into `fragments` buffers. If any filters are given, only benchmarks
+ * whose name contains one of the filters are run.
+ */
+
+#include "../../../testing/socket_pair.hpp"
+
+#include <neo/io/read.hpp>
+#include <neo/io/stream/dynbuf.hpp>
+#include <neo/io/stream/file.hpp>
+#include <neo/io/stream/listener.hpp>
+#include <neo/io/stream/native.hpp>
+#include <neo/io/stream/socket.hpp>
+#include <neo/io/stream/string.hpp>
+#include <neo/io/write.hpp>
+
+#include <neo/io/config.hpp>
+
+#if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
+#include "../../../testing/certs.hpp"
+
+#include <neo/io/openssl/context.hpp>
+#include <neo/io/openssl/engine.hpp>
+#include <neo/io/openssl/init.hpp>
+#include <neo/io/stream/buffers.hpp>
+#endif
+
+#include <neo/platform.hpp>
+
+#if NEO_OS_IS_UNIX_LIKE
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_options {
+    std::chrono::milliseconds min_time{250};
+    std::vector<std::string>  filters;
+} options;
+
+bool selected(std::string_view name) {
+    if (options.filters.empty()) {
+        return true;
+    }
+    for (auto& f : options.filters) {
+        if (name.find(f) != name.npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[[noreturn]] void fail(std::string_view name, std::string_view what) {
+    std::fprintf(stderr,
+                 "Benchmark %.*s failed: %.*s\n",
+                 int(name.size()),
+                 name.data(),
+                 int(what.size()),
+                 what.data());
+    std::exit(1);
+}
+
+template <typename Result>
+void check(std::string_view name, const Result& res, std::size_t expect_bytes) {
+    if (neo::transfer_errant(res)) {
+        fail(name, res.error().message());
+    }
+    if (res.bytes_transferred != expect_bytes) {
+        fail(name, "Short transfer");
+    }
+}
+
+struct param {
+    const char* key;
+    std::size_t value;
+};
+
+/**
+ * Run `op` in batches, doubling the batch size until a batch takes at least
+ * `options.min_time`, then print the timing of the final batch.
+ */
+template <typename Op>
+void run_bench(std::string_view             name,
+               std::initializer_list<param> params,
+               std::size_t                  bytes_per_op,
+               Op&&                         op) {
+    if (!selected(name)) {
+        return;
+    }
+    // Warm up caches and lazily-allocated buffers
+    op();
+    for (std::uint64_t n_ops = 1;; n_ops *= 2) {
+        const auto start = bench_clock::now();
+        for (std::uint64_t i = 0; i < n_ops; ++i) {
+            op();
+        }
+        const auto elapsed = bench_clock::now() - start;
+        if (elapsed < options.min_time) {
+            continue;
+        }
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        std::printf("{\"benchmark\":\"%.*s\"", int(name.size()), name.data());
+        for (auto& p : params) {
+            std::printf(",\"%s\":%zu", p.key, p.value);
+        }
+        std::printf(",\"iterations\":%llu,\"ns_per_op\":%.1f,\"bytes_per_second\":%.0f}\n",
+                    static_cast<unsigned long long>(n_ops),
+                    ns / double(n_ops),
+                    double(bytes_per_op) * double(n_ops) * 1e9 / ns);
+        std::fflush(stdout);
+        return;
+    }
+}
+
+/**
+ * `buffer_size` bytes of storage, split into `fragments` buffers.
+ */
+struct fragmented_buffers {
+    std::vector<std::byte>           storage;
+    std::vector<neo::mutable_buffer> bufs;
+
+    fragmented_buffers(std::size_t buffer_size, std::size_t fragments)
+        : storage(buffer_size, std::byte{'x'}) {
+        const auto frag_size = buffer_size / fragments;
+        for (auto i = 0u; i < fragments; ++i) {
+            bufs.emplace_back(storage.data() + i * frag_size, frag_size);
+        }
+    }
+
+    /// A non-owning view of the buffers, which is cheap to pass to read_some()/write_some()
+    std::span<const neo::mutable_buffer> parts() const noexcept { return bufs; }
+
+#if NEO_OS_IS_UNIX_LIKE
+    std::vector<::iovec> iovecs() const {
+        std::vector<::iovec> ret;
+        for (auto& b : bufs) {
+            ret.push_back({b.data(), b.size()});
+        }
+        return ret;
+    }
+#endif
+};
+
+constexpr std::size_t buffer_sizes[] = {64, 4096, 64 * 1024};
+constexpr std::size_t fragments[]    = {1, 16, 64};
+
+/**
+ * Call `fn(buffer_size, fragments)` for every combination of buffer size
+ * and fragment count.
+ */
+template <typename Fn>
+void for_each_shape(Fn&& fn) {
+    for (auto size : buffer_sizes) {
+        for (auto frags : fragments) {
+            if (frags <= size) {
+                fn(size, frags);
+            }
+        }
+    }
+}
+
+/**
+ * Write then read back `buffer_size` bytes through a stream in each operation.
+ * The stream must be able to hold a whole operation's worth of data, so that
+ * a single thread can drive both ends.
+ */
+template <typename Out, typename In>
+void bench_roundtrip(std::string_view name, Out& out, In& in) {
+    for_each_shape([&](std::size_t size, std::size_t frags) {
+        fragmented_buffers fb{size, frags};
+        run_bench(name, {{"buffer_size", size}, {"fragments", frags}}, size, [&] {
+            if (frags == 1) {
+                check(name, neo::write(out, neo::const_buffer(fb.bufs[0])), size);
+                check(name, neo::read(in, fb.bufs[0]), size);
+            } else {
+                check(name, neo::write(out, fb.parts()), size);
+                check(name, neo::read(in, fb.parts()), size);
+            }
+        });
+    });
+}
+
+void bench_memory_streams() {
+    std::string        str;
+    neo::dynbuf_stream dynbuf{neo::as_dynamic_buffer(str)};
+    bench_roundtrip("roundtrip/dynbuf", dynbuf, dynbuf);
+
+    neo::string_stream strm;
+    bench_roundtrip("roundtrip/string", strm, strm);
+}
+
+#if NEO_OS_IS_UNIX_LIKE
+
+void bench_pipe() {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        fail("roundtrip/pipe", "pipe() failed");
+    }
+    neo::native_stream read_end{std::move(fds[0])};
+    neo::native_stream write_end{std::move(fds[1])};
+    bench_roundtrip("roundtrip/pipe", write_end, read_end);
+}
+
+void bench_file() {
+    const auto path = std::filesystem::temp_directory_path() / "neo-io-bench.tmp";
+    auto       file = neo::file_stream::open(path,
+                                       neo::open_mode::read | neo::open_mode::write
+                                           | neo::open_mode::create);
+    std::filesystem::remove(path);
+    std::string_view name = "roundtrip/file";
+    for_each_shape([&](std::size_t size, std::size_t frags) {
+        fragmented_buffers fb{size, frags};
+        run_bench(name, {{"buffer_size", size}, {"fragments", frags}}, size, [&] {
+            check(name, neo::write_at(file, 0, fb.parts()), size);
+            check(name, neo::read_at(file, 0, fb.parts()), size);
+        });
+    });
+}
+
+void bench_socket() {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto [client, server] = neo::testing::make_socket_pair(lis);
+    bench_roundtrip("roundtrip/socket", client, server);
+}
+
+/**
+ * Compare neo::write()/neo::read() of a fragmented buffer with a single call
+ * to writev()/readv(). The devices always transfer everything at once, so the
+ * difference is the overhead of the composed operation.
+ */
+void bench_io_op_overhead() {
+    auto dev_null = neo::file_stream::open("/dev/null", neo::open_mode::write);
+    auto dev_zero = neo::file_stream::open("/dev/zero");
+    auto null_fd  = neo::native_handle_of(dev_null);
+    auto zero_fd  = neo::native_handle_of(dev_zero);
+
+    for_each_shape([&](std::size_t size, std::size_t frags) {
+        fragmented_buffers fb{size, frags};
+        auto               iov    = fb.iovecs();
+        const auto         n_iov  = static_cast<int>(iov.size());
+        auto               params = {param{"buffer_size", size}, param{"fragments", frags}};
+
+        run_bench("io_op/write", params, size, [&] {
+            check("io_op/write", neo::write(dev_null, fb.parts()), size);
+        });
+        run_bench("io_op/raw_writev", params, size, [&] {
+            if (::writev(null_fd, iov.data(), n_iov) != static_cast<::ssize_t>(size)) {
+                fail("io_op/raw_writev", "writev() failed");
+            }
+        });
+        run_bench("io_op/read", params, size, [&] {
+            check("io_op/read", neo::read(dev_zero, fb.parts()), size);
+        });
+        run_bench("io_op/raw_readv", params, size, [&] {
+            if (::readv(zero_fd, iov.data(), n_iov) != static_cast<::ssize_t>(size)) {
+                fail("io_op/raw_readv", "readv() failed");
+            }
+        });
+    });
+}
+
+#endif  // NEO_OS_IS_UNIX_LIKE
+
+#if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
+
+using neo::ssl::testing::localhost_cert;
+using neo::ssl::testing::localhost_key;
+
+using mem_buffers = neo::stream_io_buffers<neo::string_stream&>;
+using mem_engine  = neo::ssl::engine<mem_buffers, mem_buffers>;
+
+/**
+ * A client and server engine connected to each other through two strings.
+ */
+struct mem_tls_pair {
+    neo::string_stream to_server;
+    neo::string_stream to_client;
+    mem_engine         client;
+    mem_engine         server;
+
+    mem_tls_pair(neo::ssl::context& client_ctx, neo::ssl::context& server_ctx)
+        : client(client_ctx, mem_buffers{to_client}, mem_buffers{to_server})
+        , server(server_ctx, mem_buffers{to_server}, mem_buffers{to_client}) {}
+
+    /// Drive both handshakes to completion. The engines report `no_message`
+    /// whenever they are waiting on the other.
+    void handshake(std::string_view name) {
+        std::error_code client_ec = make_error_code(std::errc::no_message);
+        std::error_code server_ec = make_error_code(std::errc::no_message);
+        const auto      waiting   = make_error_code(std::errc::no_message);
+        while (client_ec == waiting || server_ec == waiting) {
+            if (client_ec == waiting) {
+                client.connect(client_ec);
+            }
+            if (server_ec == waiting) {
+                server.accept(server_ec);
+            }
+        }
+        if (client_ec || server_ec) {
+            fail(name, (client_ec ? client_ec : server_ec).message());
+        }
+    }
+};
+
+void bench_tls() {
+    neo::ssl::openssl_app_init init;
+
+    neo::ssl::context server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    neo::ssl::context client_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::client};
+    client_ctx.add_certificate_authority(localhost_cert);
+    client_ctx.set_verify_mode(neo::ssl::verify_mode::peer);
+
+    run_bench("tls/handshake", {}, 0, [&] {
+        mem_tls_pair pair{client_ctx, server_ctx};
+        pair.handshake("tls/handshake");
+    });
+
+    mem_tls_pair pair{client_ctx, server_ctx};
+    pair.handshake("tls/bulk");
+    for (std::size_t size : {1024, 16 * 1024, 256 * 1024}) {
+        std::vector<std::byte> plain(size, std::byte{'x'});
+        neo::mutable_buffer    buf{plain.data(), size};
+        run_bench("tls/bulk", {{"buffer_size", size}}, size, [&] {
+            check("tls/bulk", neo::write(pair.client, neo::const_buffer(buf)), size);
+            check("tls/bulk", neo::read(pair.server, buf), size);
+        });
+    }
+}
+
+#endif  // OpenSSL_Support
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    for (auto i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--min-time=")) {
+            options.min_time = std::chrono::milliseconds{
+                std::strtoll(argv[i] + arg.find('=') + 1, nullptr, 10)};
+        } else {
+            options.filters.emplace_back(arg);
+        }
+    }
+
+    bench_memory_streams();
+#if NEO_OS_IS_UNIX_LIKE
+    bench_pipe();
+    bench_file();
+    bench_socket();
+    bench_io_op_overhead();
+#endif
+#if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
+    bench_tls();
+#endif
+}
@@ -18,6 +18,16 @@ template <typename T, typename Stream>
 concept read_completion_condition_for =
     neo::invocable<T, read_result_t<Stream>> &&
     neo::same_as<std::invoke_result_t<T, read_result_t<Stream>>, std::size_t>;
+
+template <typename T, typename Stream>
+concept write_at_completion_condition_for =
+    neo::invocable<T, write_at_result_t<Stream>> &&
+    neo::same_as<std::invoke_result_t<T, write_at_result_t<Stream>>, std::size_t>;
+
+template <typename T, typename Stream>
+concept read_at_completion_condition_for =
+    neo::invocable<T, read_at_result_t<Stream>> &&
+    neo::same_as<std::invoke_result_t<T, read_at_result_t<Stream>>, std::size_t>;
 // clang-format on
 
 /**
@@ -6,6 +6,8 @@
 #include <neo/mutable_buffer.hpp>
 #include <neo/ref.hpp>
 
+#include <cstdint>
+
 namespace neo {
 
 // clang-format off
@@ -18,6 +20,27 @@ template <typename T>
 concept vectored_read_stream =
     read_stream<T> &&
     read_stream<T, proto_mutable_buffer_range>;
+
+/**
+ * A `random_access_read_stream` can read data from a given offset, independent
+ * of any stream position.
+ */
+template <typename T, typename Bufs = mutable_buffer>
+concept random_access_read_stream = requires(T stream, std::uint64_t offset, Bufs buf) {
+    { stream.read_some_at(offset, buf) } noexcept -> transfer_result;
+};
+
+/**
+ * A `vectored_random_access_read_stream` can also read a buffer range at an offset
+ * in a single operation.
+ *
+ * @note On Windows, `file_stream` does not satisfy this concept: a Win32 handle
+ * only reads a single buffer at an offset.
+ */
+template <typename T>
+concept vectored_random_access_read_stream =
+    random_access_read_stream<T> &&
+    random_access_read_stream<T, proto_mutable_buffer_range>;
 // clang-format on
 
 /**
@@ -31,6 +54,15 @@ template <read_stream Stream, typename Bufs = mutable_buffer>
 requires read_stream<Stream, Bufs>  //
     using read_result_t = std::decay_t<decltype(ref_v<Stream>.read_some(cref_v<Bufs>))>;
 
+/**
+ * @brief Obtain the transfer_result type of the read_some_at() of the given
+ * random_access_read_stream.
+ */
+template <random_access_read_stream Stream, typename Bufs = mutable_buffer>
+requires random_access_read_stream<Stream, Bufs>  //
+    using read_at_result_t
+    = std::decay_t<decltype(ref_v<Stream>.read_some_at(std::uint64_t(), cref_v<Bufs>))>;
+
 struct proto_read_stream {
     proto_read_stream()  = delete;
     ~proto_read_stream() = delete;
@@ -46,4 +78,19 @@ struct proto_vectored_read_stream {
     proto_transfer_result read_some(S&&) noexcept;
 };
 
+struct proto_random_access_read_stream {
+    proto_random_access_read_stream()  = delete;
+    ~proto_random_access_read_stream() = delete;
+
+    proto_transfer_result read_some_at(std::uint64_t, mutable_buffer) noexcept;
+};
+
+struct proto_vectored_random_access_read_stream {
+    proto_vectored_random_access_read_stream()  = delete;
+    ~proto_vectored_random_access_read_stream() = delete;
+
+    template <mutable_buffer_range S>
+    proto_transfer_result read_some_at(std::uint64_t, S&&) noexcept;
+};
+
 }  // namespace neo
@@ -4,3 +4,6 @@
 
 NEO_TEST_CONCEPT(neo::read_stream<neo::proto_read_stream>);
 NEO_TEST_CONCEPT(neo::vectored_read_stream<neo::proto_vectored_read_stream>);
+NEO_TEST_CONCEPT(neo::random_access_read_stream<neo::proto_random_access_read_stream>);
+NEO_TEST_CONCEPT(
+    neo::vectored_random_access_read_stream<neo::proto_vectored_random_access_read_stream>);
@@ -68,6 +68,27 @@ template <transfer_result Res>
     }
 }
 
+/**
+ * @brief Determine whether a transfer failed only because a non-blocking
+ * stream was not ready.
+ *
+ * Uses the `.would_block()` method of the result, if present. Otherwise checks
+ * whether the error is `operation_would_block` or `resource_unavailable_try_again`.
+ */
+template <transfer_result Res>
+[[nodiscard]] constexpr bool transfer_would_block(const Res& r) noexcept {
+    if constexpr (requires { r.would_block(); }) {
+        return r.would_block();
+    } else {
+        if (!transfer_errant(r)) {
+            return false;
+        }
+        auto ec = std::error_code(r.error());
+        return ec == std::errc::operation_would_block
+            || ec == std::errc::resource_unavailable_try_again;
+    }
+}
+
 /**
  * @brief If the given transfer result has an error, throws an instance of
  * `std::system_error`.
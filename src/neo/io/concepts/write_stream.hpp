@@ -6,6 +6,8 @@
 #include <neo/const_buffer.hpp>
 #include <neo/ref.hpp>
 
+#include <cstdint>
+
 namespace neo {
 
 // clang-format off
@@ -18,12 +20,42 @@ template <typename T>
 concept vectored_write_stream =
     write_stream<T> &&
     write_stream<T, proto_buffer_range>;
+
+/**
+ * A `random_access_write_stream` can write data at a given offset, independent
+ * of any stream position.
+ */
+template <typename T, typename Bufs = const_buffer>
+concept random_access_write_stream = requires(T stream, std::uint64_t offset, Bufs buf) {
+    { stream.write_some_at(offset, buf) } noexcept -> transfer_result;
+};
+
+/**
+ * A `vectored_random_access_write_stream` can also write a buffer range at an offset
+ * in a single operation.
+ *
+ * @note On Windows, `file_stream` does not satisfy this concept: a Win32 handle
+ * only writes a single buffer at an offset.
+ */
+template <typename T>
+concept vectored_random_access_write_stream =
+    random_access_write_stream<T> &&
+    random_access_write_stream<T, proto_buffer_range>;
 // clang-format on
 
 template <write_stream Stream, typename Bufs = const_buffer>
 requires write_stream<Stream, Bufs>  //
     using write_result_t = std::decay_t<decltype(ref_v<Stream>.write_some(cref_v<Bufs>))>;
 
+/**
+ * @brief Obtain the transfer_result type of the write_some_at() of the given
+ * random_access_write_stream.
+ */
+template <random_access_write_stream Stream, typename Bufs = const_buffer>
+requires random_access_write_stream<Stream, Bufs>  //
+    using write_at_result_t
+    = std::decay_t<decltype(ref_v<Stream>.write_some_at(std::uint64_t(), cref_v<Bufs>))>;
+
 struct proto_write_stream {
     proto_write_stream()  = delete;
     ~proto_write_stream() = delete;
@@ -39,7 +71,24 @@ struct proto_vectored_write_stream {
     proto_transfer_result write_some(R&&) noexcept;
 };
 
+struct proto_random_access_write_stream {
+    proto_random_access_write_stream()  = delete;
+    ~proto_random_access_write_stream() = delete;
+
+    proto_transfer_result write_some_at(std::uint64_t, const_buffer) noexcept;
+};
+
+struct proto_vectored_random_access_write_stream {
+    proto_vectored_random_access_write_stream()  = delete;
+    ~proto_vectored_random_access_write_stream() = delete;
+
+    template <buffer_range R>
+    proto_transfer_result write_some_at(std::uint64_t, R&&) noexcept;
+};
+
 static_assert(write_stream<proto_write_stream>);
 static_assert(vectored_write_stream<proto_vectored_write_stream>);
+static_assert(random_access_write_stream<proto_random_access_write_stream>);
+static_assert(vectored_random_access_write_stream<proto_vectored_random_access_write_stream>);
 
 }  // namespace neo
@@ -15,6 +15,7 @@
 #include <openssl/conf.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/pem.h>
 #include <openssl/ssl.h>
 #include <openssl/tls1.h>
 
@@ -143,5 +144,196 @@ void context::_close() {
     _ssl_ctx_ptr = nullptr;
 }
 
+namespace {
+
+std::error_code current_error() noexcept {
+    return std::error_code(static_cast<int>(::ERR_get_error()), error_category());
+}
+
+/// Owns a read-only memory BIO over PEM data
+struct mem_bio {
+    ::BIO* ptr;
+
+    explicit mem_bio(std::string_view data) noexcept
+        : ptr(::BIO_new_mem_buf(data.data(), static_cast<int>(data.size()))) {}
+    ~mem_bio() { ::BIO_free(ptr); }
+
+    mem_bio(const mem_bio&) = delete;
+    mem_bio& operator=(const mem_bio&) = delete;
+};
+
+/**
+ * Reading PEM objects until the end of the input leaves a "no start line"
+ * error in the queue. Clear it, and report any other error.
+ */
+void check_pem_end(std::error_code& ec) noexcept {
+    auto err = ::ERR_peek_last_error();
+    if (ERR_GET_LIB(err) == ERR_LIB_PEM && ERR_GET_REASON(err) == PEM_R_NO_START_LINE) {
+        ::ERR_clear_error();
+    } else if (err) {
+        ec = current_error();
+    }
+}
+
+}  // namespace
+
+void context::use_certificate_chain_file(const std::string& path, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    if (::SSL_CTX_use_certificate_chain_file(MY_CTX_PTR, path.data()) != 1) {
+        ec = current_error();
+    }
+}
+
+void context::use_certificate_chain(std::string_view pem, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    mem_bio bio{pem};
+    auto    cert = ::PEM_read_bio_X509_AUX(bio.ptr, nullptr, nullptr, nullptr);
+    if (!cert) {
+        ec = current_error();
+        return;
+    }
+    auto ok = ::SSL_CTX_use_certificate(MY_CTX_PTR, cert);
+    ::X509_free(cert);
+    if (ok != 1 || ::SSL_CTX_clear_chain_certs(MY_CTX_PTR) != 1) {
+        ec = current_error();
+        return;
+    }
+    while (auto ca = ::PEM_read_bio_X509(bio.ptr, nullptr, nullptr, nullptr)) {
+        // On success, the context takes ownership of the certificate
+        if (::SSL_CTX_add0_chain_cert(MY_CTX_PTR, ca) != 1) {
+            ::X509_free(ca);
+            ec = current_error();
+            return;
+        }
+    }
+    check_pem_end(ec);
+}
+
+void context::use_private_key_file(const std::string& path, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    if (::SSL_CTX_use_PrivateKey_file(MY_CTX_PTR, path.data(), SSL_FILETYPE_PEM) != 1) {
+        ec = current_error();
+    }
+}
+
+void context::use_private_key(std::string_view pem, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    mem_bio bio{pem};
+    auto    key = ::PEM_read_bio_PrivateKey(bio.ptr, nullptr, nullptr, nullptr);
+    if (!key) {
+        ec = current_error();
+        return;
+    }
+    auto ok = ::SSL_CTX_use_PrivateKey(MY_CTX_PTR, key);
+    ::EVP_PKEY_free(key);
+    if (ok != 1) {
+        ec = current_error();
+    }
+}
+
+void context::load_verify_file(const std::string& path, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    if (::SSL_CTX_load_verify_locations(MY_CTX_PTR, path.data(), nullptr) != 1) {
+        ec = current_error();
+    }
+}
+
+void context::add_certificate_authority(std::string_view pem, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    mem_bio bio{pem};
+    auto    store = ::SSL_CTX_get_cert_store(MY_CTX_PTR);
+    while (auto ca = ::PEM_read_bio_X509(bio.ptr, nullptr, nullptr, nullptr)) {
+        auto ok = ::X509_STORE_add_cert(store, ca);
+        ::X509_free(ca);
+        if (ok != 1) {
+            ec = current_error();
+            return;
+        }
+    }
+    check_pem_end(ec);
+}
+
+void context::set_default_verify_paths(std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    if (::SSL_CTX_set_default_verify_paths(MY_CTX_PTR) != 1) {
+        ec = current_error();
+    }
+}
+
+void context::set_verify_mode(verify_mode mode) noexcept {
+    int flags = SSL_VERIFY_NONE;
+    switch (mode) {
+    case verify_mode::none:
+        break;
+    case verify_mode::peer:
+        flags = SSL_VERIFY_PEER;
+        break;
+    case verify_mode::require_peer:
+        flags = SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
+        break;
+    }
+    ::SSL_CTX_set_verify(MY_CTX_PTR, flags, nullptr);
+}
+
+void context::set_server_session_options(const server_session_options& opts,
+                                         std::error_code&              ec) noexcept {
+    ::ERR_clear_error();
+    auto cache_mode = opts.enable_cache ? SSL_SESS_CACHE_SERVER : SSL_SESS_CACHE_OFF;
+    ::SSL_CTX_set_session_cache_mode(MY_CTX_PTR, cache_mode);
+    ::SSL_CTX_sess_set_cache_size(MY_CTX_PTR, static_cast<long>(opts.cache_size));
+    ::SSL_CTX_set_timeout(MY_CTX_PTR, static_cast<long>(opts.timeout.count()));
+    if (opts.enable_tickets) {
+        ::SSL_CTX_clear_options(MY_CTX_PTR, SSL_OP_NO_TICKET);
+    } else {
+        ::SSL_CTX_set_options(MY_CTX_PTR, SSL_OP_NO_TICKET);
+    }
+    auto& sid_ctx = opts.session_id_context;
+    if (::SSL_CTX_set_session_id_context(MY_CTX_PTR,
+                                         reinterpret_cast<const unsigned char*>(sid_ctx.data()),
+                                         static_cast<unsigned>(sid_ctx.size()))
+        != 1) {
+        ec = current_error();
+    }
+}
+
+void context::set_session_cache(std::shared_ptr<session_cache> cache) noexcept {
+    _session_cache = std::move(cache);
+    detail::attach_session_cache(_ssl_ctx_ptr, _session_cache.get());
+}
+
+namespace {
+
+int sni_trampoline(::SSL* ssl, int*, void* arg) noexcept {
+    auto& cb   = *static_cast<sni_callback*>(arg);
+    auto  name = ::SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (!name) {
+        // No server name was requested. Use the default context.
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    try {
+        auto ctx = cb(name);
+        if (ctx && ::SSL_set_SSL_CTX(ssl, static_cast<::SSL_CTX*>(ctx->c_ptr())) == nullptr) {
+            return SSL_TLSEXT_ERR_ALERT_FATAL;
+        }
+        return SSL_TLSEXT_ERR_OK;
+    } catch (...) {
+        return SSL_TLSEXT_ERR_ALERT_FATAL;
+    }
+}
+
+}  // namespace
+
+void context::set_sni_callback(sni_callback cb) {
+    if (!cb) {
+        ::SSL_CTX_set_tlsext_servername_callback(MY_CTX_PTR, nullptr);
+        _sni_cb.reset();
+        return;
+    }
+    // The callback lives on the heap, so that its address is stable when the context moves
+    _sni_cb = std::make_unique<sni_callback>(std::move(cb));
+    ::SSL_CTX_set_tlsext_servername_arg(MY_CTX_PTR, _sni_cb.get());
+    ::SSL_CTX_set_tlsext_servername_callback(MY_CTX_PTR, &sni_trampoline);
+}
+
 #endif
 #endif
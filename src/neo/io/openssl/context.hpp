@@ -1,11 +1,20 @@
 #pragma once
 
 #include "./init.hpp"
+#include "./session_cache.hpp"
 
 #include <neo/io/config.hpp>
 
+#include <neo/error.hpp>
 #include <neo/utility.hpp>
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
 namespace neo::ssl {
 
 /**
@@ -31,11 +40,55 @@ enum class role {
     server,
 };
 
+/**
+ * @brief How an engine verifies the certificate of its peer.
+ */
+enum class verify_mode {
+    /// Do not verify the peer
+    none,
+    /// Verify the peer's certificate, if the peer sends one. A client always
+    /// receives a certificate from the server.
+    peer,
+    /// Verify the peer's certificate, and fail if the peer does not send one.
+    require_peer,
+};
+
+/**
+ * @brief Control how a server allows clients to resume earlier sessions.
+ */
+struct server_session_options {
+    /// Keep sessions in the context's session ID cache
+    bool enable_cache = true;
+    /// The most sessions to keep in the session ID cache
+    std::size_t cache_size = 1024 * 20;
+    /// How long a session may be resumed after it is created
+    std::chrono::seconds timeout{60 * 5};
+    /// Issue session tickets, so that clients may resume without a cache entry
+    bool enable_tickets = true;
+    /**
+     * Sessions are only resumed within the same session ID context. Servers
+     * that share a cache or ticket keys should use the same value.
+     */
+    std::string session_id_context = "neo::ssl";
+};
+
+class context;
+
+/**
+ * @brief Select the context to use for a connection, based on the server name
+ * (SNI) requested by the client.
+ *
+ * Return `nullptr` to continue with the default context.
+ */
+using sni_callback = std::function<context*(std::string_view server_name)>;
+
 /**
  * @brief Represents an OpenSSL API context. All engines are created against a context.
  */
 class NEO_IO_OPENSSL_API_ATTR context {
-    void* _ssl_ctx_ptr = nullptr;
+    void*                          _ssl_ctx_ptr = nullptr;
+    std::unique_ptr<sni_callback>  _sni_cb;
+    std::shared_ptr<session_cache> _session_cache;
 
     void _close();
 
@@ -44,14 +97,120 @@ public:
     ~context() { _close(); }
 
     context(context&& o) noexcept
-        : _ssl_ctx_ptr(neo::take(o._ssl_ctx_ptr)) {}
+        : _ssl_ctx_ptr(neo::take(o._ssl_ctx_ptr))
+        , _sni_cb(std::move(o._sni_cb))
+        , _session_cache(std::move(o._session_cache)) {}
 
     context& operator=(context&& c) noexcept {
         _close();
-        _ssl_ctx_ptr = neo::take(c._ssl_ctx_ptr);
+        _ssl_ctx_ptr   = neo::take(c._ssl_ctx_ptr);
+        _sni_cb        = std::move(c._sni_cb);
+        _session_cache = std::move(c._session_cache);
         return *this;
     }
 
+    /**
+     * @brief Load the certificate chain to present to peers from a PEM file.
+     *
+     * The file begins with the certificate of this endpoint, followed by any
+     * intermediate certificates.
+     */
+    void use_certificate_chain_file(const std::string& path, std::error_code& ec) noexcept;
+    void use_certificate_chain_file(const std::string& path) {
+        use_certificate_chain_file(path, "Failed to load certificate chain file"_ec_throw);
+    }
+
+    /**
+     * @brief Load the certificate chain to present to peers from PEM data in
+     * memory. The format is the same as use_certificate_chain_file().
+     */
+    void use_certificate_chain(std::string_view pem, std::error_code& ec) noexcept;
+    void use_certificate_chain(std::string_view pem) {
+        use_certificate_chain(pem, "Failed to load certificate chain"_ec_throw);
+    }
+
+    /**
+     * @brief Load the private key of this endpoint from a PEM file. The key
+     * must match the certificate, if one has already been loaded.
+     */
+    void use_private_key_file(const std::string& path, std::error_code& ec) noexcept;
+    void use_private_key_file(const std::string& path) {
+        use_private_key_file(path, "Failed to load private key file"_ec_throw);
+    }
+
+    /**
+     * @brief Load the private key of this endpoint from PEM data in memory.
+     */
+    void use_private_key(std::string_view pem, std::error_code& ec) noexcept;
+    void use_private_key(std::string_view pem) {
+        use_private_key(pem, "Failed to load private key"_ec_throw);
+    }
+
+    /**
+     * @brief Trust the certificate authorities in the given PEM file when
+     * verifying peers.
+     */
+    void load_verify_file(const std::string& path, std::error_code& ec) noexcept;
+    void load_verify_file(const std::string& path) {
+        load_verify_file(path, "Failed to load certificate authority file"_ec_throw);
+    }
+
+    /**
+     * @brief Trust the certificate authorities in the given PEM data when
+     * verifying peers.
+     */
+    void add_certificate_authority(std::string_view pem, std::error_code& ec) noexcept;
+    void add_certificate_authority(std::string_view pem) {
+        add_certificate_authority(pem, "Failed to add certificate authority"_ec_throw);
+    }
+
+    /**
+     * @brief Trust the system's default certificate authorities when verifying
+     * peers.
+     */
+    void set_default_verify_paths(std::error_code& ec) noexcept;
+    void set_default_verify_paths() {
+        set_default_verify_paths("Failed to load the default certificate authorities"_ec_throw);
+    }
+
+    /**
+     * @brief Set how engines created against this context verify their peer.
+     */
+    void set_verify_mode(verify_mode) noexcept;
+
+    /**
+     * @brief Set a callback to select a context for each server connection
+     * based on the server name requested by the client (SNI).
+     *
+     * The selected context provides the certificate and key for the
+     * connection. Contexts returned by the callback must outlive any
+     * connections that use them. Connections that do not request a server
+     * name use this context.
+     */
+    void set_sni_callback(sni_callback cb);
+
+    /**
+     * @brief Configure server-side session resumption for connections accepted
+     * with this context.
+     */
+    void set_server_session_options(const server_session_options& opts,
+                                    std::error_code&              ec) noexcept;
+    void set_server_session_options(const server_session_options& opts) {
+        set_server_session_options(opts, "Failed to set server session options"_ec_throw);
+    }
+
+    /**
+     * @brief Cache the sessions of client connections in the given cache, and
+     * offer cached sessions to servers when connecting. Pass `nullptr` to stop
+     * caching.
+     *
+     * Engines only use the cache if they are given a session key. See
+     * engine_base::set_session_key(). A context with a session cache should
+     * only be used for client connections.
+     */
+    void set_session_cache(std::shared_ptr<session_cache> cache) noexcept;
+    auto& get_session_cache() const noexcept { return _session_cache; }
+
     void*       c_ptr() noexcept { return _ssl_ctx_ptr; }
     const void* c_ptr() const noexcept { return _ssl_ctx_ptr; }
 };
@@ -3,8 +3,14 @@
 #include <neo/io/config.hpp>
 
 #include <neo/as_buffer.hpp>
+#include <neo/assert.hpp>
 #include <neo/event.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
 #if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
 
 #include "./error.hpp"
@@ -46,20 +52,28 @@ struct engine_impl {
         ec = {};
         for (;;) {
             auto state = one_step(static_cast<::SSL*>(eng._ssl_ptr), ec, fn);
-            if (ec) {
+            if (eng._io_error) {
+                // The Input or Output failed. This is the root cause of whatever OpenSSL told us.
+                ec = std::exchange(eng._io_error, {});
                 break;
             }
-            try {
-                ec = make_error_code(flush_io(eng));
-            } catch (const std::system_error& err) {
-                ec = err.code();
-            }
             if (state == stop || ec) {
                 break;
             }
+            if (is_direct(eng)) {
+                // OpenSSL is using a non-blocking socket, and it isn't ready
+                ec = make_error_code(std::errc::operation_would_block);
+                break;
+            }
         }
     }
 
+    /// Whether OpenSSL is doing I/O directly on a socket, rather than through our BIO
+    static bool is_direct(const engine_base& eng) noexcept {
+        auto bio = static_cast<::BIO*>(eng._bio_ptr);
+        return bio && ::BIO_method_type(bio) == BIO_TYPE_SOCKET;
+    }
+
     /**
      * Call fn() once, and determine what we need to do next.
      */
@@ -102,36 +116,133 @@ struct engine_impl {
         }
     }
 
+    static engine_base& bio_engine(::BIO* bio) noexcept {
+        return *static_cast<engine_base*>(::BIO_get_data(bio));
+    }
+
+    /// The error code for the exception being handled, which was thrown by the Input or Output
+    static std::error_code current_exception_code() noexcept {
+        try {
+            throw;
+        } catch (const std::system_error& err) {
+            return err.code();
+        } catch (const std::bad_alloc&) {
+            return make_error_code(std::errc::not_enough_memory);
+        } catch (...) {
+            return make_error_code(std::errc::io_error);
+        }
+    }
+
+    /// Record an error from the Input or Output, and tell OpenSSL to try again later
+    static int bio_fail(::BIO* bio, std::error_code ec, int retry_flags) noexcept {
+        bio_engine(bio)._io_error = ec;
+        ::BIO_set_flags(bio, retry_flags | BIO_FLAGS_SHOULD_RETRY);
+        return -1;
+    }
+
     /**
-     * Advance the buffer_sink and buffer_source of this engine.
-     * @return std::errc A possible error
+     * BIO write callback: Copy ciphertext directly into the Output.
      */
-    static std::errc flush_io(engine_base& eng) {
-        auto bio = static_cast<::BIO*>(eng._bio_ptr);
-
-        // Continually flush the output
-        while (auto n_pending = ::BIO_ctrl_pending(bio)) {
-            auto outbuf = eng.do_next_output(n_pending);
+    static int bio_write(::BIO* bio, const char* data, int len) noexcept {
+        ::BIO_clear_retry_flags(bio);
+        if (len <= 0) {
+            return 0;
+        }
+        auto& eng = bio_engine(bio);
+        try {
+            auto outbuf = eng.do_next_output(static_cast<std::size_t>(len));
             if (!outbuf) {
                 // No room for more output
-                break;
+                return bio_fail(bio, make_error_code(std::errc::no_buffer_space), BIO_FLAGS_WRITE);
             }
-            auto n_out = ::BIO_read(bio, outbuf.data(), static_cast<int>(outbuf.size()));
-            eng.do_commit_output((std::max)(n_out, 0));
+            auto n_out = (std::min)(outbuf.size(), static_cast<std::size_t>(len));
+            std::memcpy(outbuf.data(), data, n_out);
+            eng.do_commit_output(n_out);
+            eng._output_unflushed = true;
+            return static_cast<int>(n_out);
+        } catch (...) {
+            return bio_fail(bio, current_exception_code(), BIO_FLAGS_WRITE);
         }
+    }
 
-        // If we want to read, only read once
-        if (SSL_want_read(static_cast<::SSL*>(eng._ssl_ptr))) {
-            auto inbuf = eng.do_next_input();
+    /**
+     * BIO read callback: Copy ciphertext directly from the Input.
+     */
+    static int bio_read(::BIO* bio, char* dest, int len) noexcept {
+        ::BIO_clear_retry_flags(bio);
+        if (len <= 0) {
+            return 0;
+        }
+        auto& eng = bio_engine(bio);
+        try {
+            // The peer may be waiting on output that is still buffered before
+            // it will send anything to us.
+            if (eng._output_unflushed) {
+                eng.do_flush_output();
+                eng._output_unflushed = false;
+            }
+            auto want  = (std::max)(static_cast<std::size_t>(len), eng._input_chunk_size);
+            auto inbuf = eng.do_next_input(want);
             if (!inbuf) {
                 // No more input.
-                return std::errc::no_message;
+                return bio_fail(bio, make_error_code(std::errc::no_message), BIO_FLAGS_READ);
             }
-            auto n_in = ::BIO_write(bio, inbuf.data(), static_cast<int>(inbuf.size()));
-            eng.do_consume_input((std::max)(n_in, 0));
+            auto n_in = (std::min)(inbuf.size(), static_cast<std::size_t>(len));
+            std::memcpy(dest, inbuf.data(), n_in);
+            eng.do_consume_input(n_in);
+            return static_cast<int>(n_in);
+        } catch (...) {
+            return bio_fail(bio, current_exception_code(), BIO_FLAGS_READ);
         }
+    }
 
-        return {};
+    static long bio_ctrl(::BIO* bio, int cmd, long, void*) noexcept {
+        switch (cmd) {
+        case BIO_CTRL_FLUSH:
+            // OpenSSL flushes at the end of each handshake flight
+            try {
+                auto& eng = bio_engine(bio);
+                eng.do_flush_output();
+                eng._output_unflushed = false;
+                return 1;
+            } catch (...) {
+                bio_fail(bio, current_exception_code(), BIO_FLAGS_WRITE);
+                return 0;
+            }
+        default:
+            // We never hold any data of our own, so there is nothing else to do
+            return 0;
+        }
+    }
+
+    static int bio_create(::BIO* bio) noexcept {
+        ::BIO_set_init(bio, 1);
+        return 1;
+    }
+
+    /// The BIO_METHOD shared by all engines. Created once, and never freed.
+    static ::BIO_METHOD* bio_method() noexcept {
+        static ::BIO_METHOD* const method = [] {
+            auto m = ::BIO_meth_new(::BIO_get_new_index() | BIO_TYPE_SOURCE_SINK,
+                                    "neo::ssl::engine");
+            if (m) {
+                ::BIO_meth_set_write(m, &bio_write);
+                ::BIO_meth_set_read(m, &bio_read);
+                ::BIO_meth_set_ctrl(m, &bio_ctrl);
+                ::BIO_meth_set_create(m, &bio_create);
+            }
+            return m;
+        }();
+        return method;
+    }
+
+    static void flush_output(engine_base& eng, std::error_code& ec) noexcept {
+        try {
+            eng.do_flush_output();
+            eng._output_unflushed = false;
+        } catch (...) {
+            ec = current_exception_code();
+        }
     }
 };
 
@@ -147,28 +258,72 @@ engine_base::engine_base(context& ctx_) {
 
     ::SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE);
     ::SSL_set_mode(ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
-
-    ::BIO* inner_bio = nullptr;
-    ::BIO* outer_bio = nullptr;
-    ::BIO_new_bio_pair(&inner_bio, 0, &outer_bio, 0);
-    ::SSL_set_bio(ssl, inner_bio, inner_bio);
-    _bio_ptr = outer_bio;
+    // Take as much input as is available in one BIO read, rather than reading each record header
+    // and body separately.
+    ::SSL_set_read_ahead(ssl, 1);
+
+    auto method = detail::engine_impl::bio_method();
+    auto bio    = method ? ::BIO_new(method) : nullptr;
+    if (!bio) {
+        _free();
+        throw_current("Failed to create a BIO for a new SSL engine");
+    }
+    // The SSL object owns the BIO. We keep a pointer to update it when we move.
+    ::SSL_set_bio(ssl, bio, bio);
+    _bio_ptr = bio;
+    _attach_bio();
 }
 
 void engine_base::_free() noexcept {
-    if (_bio_ptr) {
-        ::BIO_free(MY_BIO_PTR);
-    }
     if (_ssl_ptr) {
         ::SSL_free(MY_SSL_PTR);
     }
 }
 
+void engine_base::_attach_bio() noexcept {
+    if (_bio_ptr && !detail::engine_impl::is_direct(*this)) {
+        ::BIO_set_data(MY_BIO_PTR, this);
+    }
+}
+
 void engine_base::connect(std::error_code& ec) noexcept {
     neo::emit(ev_handshake{});
     detail::engine_impl::run(*this, ec, [&] { return ::SSL_connect(MY_SSL_PTR); });
+    if (!ec) {
+        detail::engine_impl::flush_output(*this, ec);
+    }
+}
+
+void engine_base::accept(std::error_code& ec) noexcept {
+    neo::emit(ev_handshake{});
+    detail::engine_impl::run(*this, ec, [&] { return ::SSL_accept(MY_SSL_PTR); });
+    if (!ec) {
+        detail::engine_impl::flush_output(*this, ec);
+    }
+}
+
+void engine_base::set_server_name(const std::string& name, std::error_code& ec) noexcept {
+    ::ERR_clear_error();
+    if (::SSL_set_tlsext_host_name(MY_SSL_PTR, name.data()) != 1) {
+        ec = std::error_code(static_cast<int>(::ERR_get_error()), neo::ssl::error_category());
+    }
+}
+
+std::string_view engine_base::server_name() const noexcept {
+    auto name = ::SSL_get_servername(MY_SSL_PTR, TLSEXT_NAMETYPE_host_name);
+    return name ? std::string_view(name) : std::string_view();
 }
 
+void engine_base::set_session_key(std::string_view key) {
+    detail::set_session_key(_ssl_ptr, key);
+}
+
+std::string_view engine_base::session_key() const noexcept {
+    return detail::get_session_key(_ssl_ptr);
+}
+
+bool engine_base::session_reused() const noexcept { return ::SSL_session_reused(MY_SSL_PTR); }
+
 neo::basic_transfer_result engine_base::read_some(mutable_buffer mb) noexcept {
     std::error_code ec;
     std::size_t     total_read = 0;
@@ -200,9 +355,81 @@ neo::basic_transfer_result engine_base::write_some(const_buffer cb) noexcept {
 }
 
 void engine_base::shutdown(std::error_code& ec) noexcept {
-    detail::engine_impl::run(*this, ec, [&] { return ::SSL_shutdown(MY_SSL_PTR); });
+    detail::engine_impl::run(*this, ec, [&] {
+        auto rc = ::SSL_shutdown(MY_SSL_PTR);
+        // Zero means that our close_notify was sent, but the peer's has not yet been received. We
+        // don't wait for it: The connection is cleanly closed on our end (and the session may be
+        // resumed).
+        return rc == 0 ? 1 : rc;
+    });
+    if (!ec) {
+        detail::engine_impl::flush_output(*this, ec);
+    }
+}
+
+void engine_base::flush(std::error_code& ec) noexcept {
+    detail::engine_impl::flush_output(*this, ec);
 }
 
 bool engine_base::needs_input() const noexcept { return SSL_want_read(MY_SSL_PTR); }
 
+bool engine_base::has_pending_input() const noexcept {
+    return ::SSL_pending(MY_SSL_PTR) > 0 || ::SSL_has_pending(MY_SSL_PTR) == 1;
+}
+
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+#define NEO_IO_OPENSSL_HAVE_KTLS 1
+#else
+#define NEO_IO_OPENSSL_HAVE_KTLS 0
+#endif
+
+bool engine_base::enable_ktls([[maybe_unused]] int sock_fd, std::error_code& ec) noexcept {
+#if NEO_IO_OPENSSL_HAVE_KTLS
+    neo_assert(expects,
+               ::SSL_in_before(MY_SSL_PTR),
+               "enable_ktls() must be called before the TLS handshake");
+    auto bio = ::BIO_new_socket(sock_fd, BIO_NOCLOSE);
+    if (!bio) {
+        ec = std::error_code(static_cast<int>(::ERR_get_error()), neo::ssl::error_category());
+        return false;
+    }
+    ::SSL_set_options(MY_SSL_PTR, SSL_OP_ENABLE_KTLS);
+    // This frees the engine's own BIO
+    ::SSL_set_bio(MY_SSL_PTR, bio, bio);
+    _bio_ptr = bio;
+    return true;
+#else
+    (void)ec;
+    return false;
+#endif
+}
+
+bool engine_base::ktls_send() const noexcept {
+    return detail::engine_impl::is_direct(*this) && BIO_get_ktls_send(MY_BIO_PTR);
+}
+
+bool engine_base::ktls_recv() const noexcept {
+    return detail::engine_impl::is_direct(*this) && BIO_get_ktls_recv(MY_BIO_PTR);
+}
+
+neo::basic_transfer_result engine_base::sendfile([[maybe_unused]] int           file_fd,
+                                                 [[maybe_unused]] std::uint64_t offset,
+                                                 [[maybe_unused]] std::size_t   len) noexcept {
+#if NEO_IO_OPENSSL_HAVE_KTLS
+    if (ktls_send()) {
+        ::ERR_clear_error();
+        auto n_sent
+            = ::SSL_sendfile(MY_SSL_PTR, file_fd, static_cast<::off_t>(offset), len, 0);
+        if (n_sent >= 0) {
+            return {static_cast<std::size_t>(n_sent), {}};
+        }
+        if (::SSL_get_error(MY_SSL_PTR, -1) == SSL_ERROR_WANT_WRITE) {
+            return {0, make_error_code(std::errc::operation_would_block)};
+        }
+        return {0, std::error_code(last_error(), std::system_category())};
+    }
+#endif
+    return {0, make_error_code(std::errc::operation_not_supported)};
+}
+
 #endif
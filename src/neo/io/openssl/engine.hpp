@@ -5,6 +5,8 @@
 
 #include <neo/io/concepts/result.hpp>
 
+#include <neo/buffer_algorithm.hpp>
+#include <neo/buffer_range.hpp>
 #include <neo/buffer_sink.hpp>
 #include <neo/buffer_source.hpp>
 #include <neo/const_buffer.hpp>
@@ -15,6 +17,12 @@
 #include <neo/shifting_dynamic_buffer.hpp>
 #include <neo/utility.hpp>
 
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
 namespace neo::ssl {
 
 namespace detail {
@@ -39,20 +47,30 @@ struct ev_handshake {};
  * these buffer outputs. These represent the read-end and write-end of a stream
  * connected to a peer.
  *
- * The engine_base has four abstract methods:
+ * The engine_base has five abstract methods:
  *
  * - do_next_output(n) - Calls .prepare(n) on the Output and returns a single
  *   mutable_buffer. Data is copied from the internal engine into this output
  *   as that data is generated by the engine.
- * - do_next_input() - Calls .next() on the Input and returns a single
+ * - do_next_input(n) - Calls .next(n) on the Input and returns a single
  *   const_buffer. The engine expects data from the peer to appear through the
  *   Input.
  * - do_commit_output(n) - Calls .commit(n) on the Output after the engine has
  *   written `n` bytes there.
  * - do_consume_input(n) - Calls .consume(n) on the Input after the engine is
  *   done with the next `n` bytes of data from the input stream.
+ * - do_flush_output() - Calls .flush() on the Output, if it has one. This is
+ *   called before the engine waits for input from the peer (if anything was
+ *   committed since the last flush), so that output that is buffered in the
+ *   Output is not held back while we wait on a reply.
+ *
+ * OpenSSL is given a custom BIO that calls these methods directly: Ciphertext
+ * is written by OpenSSL straight into the Output's buffers, and is read from
+ * the Input's buffers, without an intermediate buffer in between. Errors
+ * thrown by the Input or Output are caught and returned from the engine
+ * operation that caused them.
  *
- * The engine<> template provides these four methods to fit with the input and
+ * The engine<> template provides these methods to fit with the input and
  * output types given to it.
  *
  * It is up to the caller to define how data is transmitted from 'Output' and
@@ -73,6 +91,45 @@ public:
         connect("Failure while initializing client-side SSL/TLS connection"_ec_throw);
     }
 
+    /**
+     * @brief Perform an OpenSSL server-side handshake operation. This must be
+     * called once before any other IO operations.
+     *
+     * The context must have a certificate and private key (or an SNI
+     * callback that selects a context that has them).
+     *
+     * @param ec Receives the error code of the operation.
+     */
+    void accept(std::error_code& ec) noexcept;
+    void accept() {
+        accept("Failure while initializing server-side SSL/TLS connection"_ec_throw);
+    }
+
+    /**
+     * @brief Set the server name to request from the server (SNI). Must be
+     * called before connect().
+     */
+    void set_server_name(const std::string& name, std::error_code& ec) noexcept;
+    void set_server_name(const std::string& name) {
+        set_server_name(name, "Failed to set the SSL/TLS server name"_ec_throw);
+    }
+
+    /// The server name given to set_server_name(), or an empty string
+    std::string_view server_name() const noexcept;
+
+    /**
+     * @brief Identify the server in the context's session cache (see
+     * context::set_session_cache()). If the cache holds a session for this
+     * key, the session is offered to the server. Must be called before
+     * connect().
+     */
+    void set_session_key(std::string_view key);
+    /// The key given to set_session_key(), or an empty string
+    std::string_view session_key() const noexcept;
+
+    /// Whether the handshake resumed an earlier session rather than creating a new one
+    bool session_reused() const noexcept;
+
     /**
      * @brief Cleanly terminate the OpenSSL connection. Once run, no other IO
      * operation may be performed.
@@ -97,32 +154,136 @@ public:
      */
     basic_transfer_result write_some(const_buffer cb) noexcept;
 
+    /// The most plaintext that will fit in a single TLS record
+    constexpr static std::size_t max_record_size = 1024 * 16;
+    /// The largest TLS record that a peer should send: A header, the plaintext, and overhead
+    constexpr static std::size_t max_ciphertext_record_size = 5 + max_record_size + 256;
+
+    /**
+     * @brief Set the fewest bytes the engine asks for from the Input when
+     * OpenSSL needs more data. Defaults to one full record.
+     *
+     * OpenSSL reads ahead of what it needs, so whatever the Input has
+     * available (up to this size) is taken at once.
+     */
+    void set_input_chunk_size(std::size_t n) noexcept { _input_chunk_size = n; }
+    std::size_t input_chunk_size() const noexcept { return _input_chunk_size; }
+
+    /**
+     * @brief Feed the plaintext data from a buffer sequence into the engine.
+     *
+     * Small buffers are gathered together so that they are sent in as few
+     * TLS records as possible, rather than one record for each buffer.
+     */
+    template <buffer_range Bufs>
+    basic_transfer_result write_some(Bufs&& bufs) noexcept {
+        if constexpr (std::convertible_to<Bufs, const_buffer>) {
+            return write_some(const_buffer(bufs));
+        } else {
+            for (const_buffer part : bufs) {
+                if (part.size() >= max_record_size) {
+                    // This already fills a record. No need to copy it.
+                    return write_some(part);
+                } else if (!part.empty()) {
+                    break;
+                }
+            }
+            std::array<std::byte, max_record_size> records;
+            auto n_gathered = buffer_copy(mutable_buffer(records.data(), records.size()), bufs);
+            return write_some(const_buffer(records.data(), n_gathered));
+        }
+    }
+
+    /**
+     * @brief Flush output that is buffered in the Output buffer_sink (if it
+     * supports flush()).
+     *
+     * Output is flushed automatically when the engine waits for input, and at
+     * the end of connect() and shutdown().
+     */
+    void flush(std::error_code& ec) noexcept;
+    void flush() { flush("Failure while flushing SSL/TLS output"_ec_throw); }
+
     bool needs_input() const noexcept;
 
+    /**
+     * @brief Whether OpenSSL holds input that has not been read: Decrypted
+     * plaintext, or records that have not yet been processed.
+     */
+    bool has_pending_input() const noexcept;
+
+    /**
+     * @brief Perform TLS directly on the given socket, and allow OpenSSL to
+     * offload record encryption to the kernel (kTLS).
+     *
+     * The engine no longer uses the Input and Output: OpenSSL reads and writes
+     * the socket itself. Must be called before the handshake. If the socket is
+     * non-blocking, operations that would block fail with
+     * `std::errc::operation_would_block`.
+     *
+     * The kernel may still decline to offload a connection (e.g. because of
+     * the negotiated cipher). Check ktls_send() and ktls_recv() after the
+     * handshake.
+     *
+     * @returns `false` if this build of OpenSSL does not support kTLS, in which
+     * case the engine is unchanged.
+     */
+    bool enable_ktls(int sock_fd, std::error_code& ec) noexcept;
+
+    /// Whether records sent on this connection are encrypted by the kernel
+    bool ktls_send() const noexcept;
+    /// Whether records received on this connection are decrypted by the kernel
+    bool ktls_recv() const noexcept;
+
+    /**
+     * @brief Send `len` bytes of the file `file_fd`, beginning at `offset`,
+     * using SSL_sendfile(). The data does not pass through userspace.
+     *
+     * Requires that ktls_send() is `true`. Otherwise fails with
+     * `std::errc::operation_not_supported`.
+     */
+    basic_transfer_result sendfile(int file_fd, std::uint64_t offset, std::size_t len) noexcept;
+
 private:
-    void* _ssl_ptr = nullptr;
-    void* _bio_ptr = nullptr;
+    void*           _ssl_ptr          = nullptr;
+    void*           _bio_ptr          = nullptr;
+    std::size_t     _input_chunk_size = max_ciphertext_record_size;
+    std::error_code _io_error;
+    /// Whether output has been committed to the Output since it was last flushed
+    bool _output_unflushed = false;
 
     virtual void do_commit_output(std::size_t n)          = 0;
     virtual void do_consume_input(std::size_t n) noexcept = 0;
 
     virtual mutable_buffer do_next_output(std::size_t n) = 0;
-    virtual const_buffer   do_next_input()               = 0;
+    virtual const_buffer   do_next_input(std::size_t n)  = 0;
+    virtual void           do_flush_output()             = 0;
 
 protected:
     engine_base(context&);
     ~engine_base() { _free(); }
     engine_base(engine_base&& o) noexcept
         : _ssl_ptr(neo::take(o._ssl_ptr))
-        , _bio_ptr(neo::take(o._bio_ptr)) {}
+        , _bio_ptr(neo::take(o._bio_ptr))
+        , _input_chunk_size(o._input_chunk_size)
+        , _io_error(std::exchange(o._io_error, {}))
+        , _output_unflushed(o._output_unflushed) {
+        _attach_bio();
+    }
 
     engine_base& operator=(engine_base&& o) noexcept {
         _free();
-        _ssl_ptr = neo::take(o._ssl_ptr);
-        _bio_ptr = neo::take(o._bio_ptr);
+        _ssl_ptr          = neo::take(o._ssl_ptr);
+        _bio_ptr          = neo::take(o._bio_ptr);
+        _input_chunk_size = o._input_chunk_size;
+        _io_error         = std::exchange(o._io_error, {});
+        _output_unflushed = o._output_unflushed;
+        _attach_bio();
         return *this;
     }
     void _free() noexcept;
+    /// Point the BIO back at this engine. Must be called when the engine moves.
+    void _attach_bio() noexcept;
 };
 
 /**
@@ -153,9 +314,15 @@ private:
         return buffers_consumer{next}.next(n);
     }
 
-    const_buffer do_next_input() override {
-        auto next = input().next(1024);
-        return buffers_consumer{next}.next(1024);
+    const_buffer do_next_input(std::size_t n) override {
+        auto next = input().next(n);
+        return buffers_consumer{next}.next(n);
+    }
+
+    void do_flush_output() override {
+        if constexpr (requires { output().flush(); }) {
+            output().flush();
+        }
     }
 
 public:
@@ -11,6 +11,7 @@
 #if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
 
 #include <csignal>
+#include <new>
 
 TEST_CASE("Initialize a connection") {
     neo::ssl::openssl_app_init init;
@@ -47,6 +48,28 @@ TEST_CASE("Initialize a connection") {
     eng.shutdown();
 }
 
+namespace {
+
+/// A buffer_sink that fails to allocate any space
+struct failing_sink {
+    neo::mutable_buffer prepare(std::size_t) { throw std::bad_alloc(); }
+    void                commit(std::size_t) {}
+};
+
+}  // namespace
+
+TEST_CASE("Exceptions from the Output are returned as errors") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          ctx{neo::ssl::protocol::tls_any, neo::ssl::role::client};
+
+    neo::string_dynbuf_io input;
+    failing_sink          output;
+    neo::ssl::engine      eng{ctx, input, output};
+    std::error_code       ec;
+    eng.connect(ec);
+    CHECK(ec == std::errc::not_enough_memory);
+}
+
 NEO_TEST_CONCEPT(
     neo::read_write_stream<neo::ssl::engine<neo::proto_buffer_source, neo::proto_buffer_sink>>);
 
@@ -0,0 +1,203 @@
+#include "./session_cache.hpp"
+
+#if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
+
+#include "./openssl.hpp"
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+
+using namespace neo::ssl;
+
+#define SESSION_PTR(Ptr) (static_cast<::SSL_SESSION*>(Ptr))
+
+namespace {
+
+/// The index of the session_cache* in the ex_data of an SSL_CTX
+int ctx_cache_index() noexcept {
+    static const int index = ::SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+/// The index of the context ID (a std::uintptr_t) in the ex_data of an SSL_CTX
+int ctx_id_index() noexcept {
+    static const int index = ::SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+std::uint64_t context_id_of(const ::SSL* ssl) noexcept {
+    return reinterpret_cast<std::uintptr_t>(
+        ::SSL_CTX_get_ex_data(::SSL_get_SSL_CTX(ssl), ctx_id_index()));
+}
+
+void free_session_key(void*, void* ptr, ::CRYPTO_EX_DATA*, int, long, void*) {
+    delete static_cast<std::string*>(ptr);
+}
+
+/// The index of the session key (a std::string*) in the ex_data of an SSL
+int ssl_key_index() noexcept {
+    static const int index
+        = ::SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &free_session_key);
+    return index;
+}
+
+session_cache* cache_of(const ::SSL* ssl) noexcept {
+    return static_cast<session_cache*>(
+        ::SSL_CTX_get_ex_data(::SSL_get_SSL_CTX(ssl), ctx_cache_index()));
+}
+
+/// Called by OpenSSL when the server gives us a session that may be resumed
+int on_new_session(::SSL* ssl, ::SSL_SESSION* sess) noexcept {
+    auto cache = cache_of(ssl);
+    auto key   = static_cast<std::string*>(::SSL_get_ex_data(ssl, ssl_key_index()));
+    if (!cache || !key) {
+        return 0;
+    }
+    try {
+        cache->put(context_id_of(ssl), *key, sess);
+        // We now own the reference
+        return 1;
+    } catch (...) {
+        return 0;
+    }
+}
+
+}  // namespace
+
+void session_cache::_erase(entry_list::iterator it) noexcept {
+    _index.erase(it->first);
+    ::SSL_SESSION_free(SESSION_PTR(it->second));
+    _entries.erase(it);
+}
+
+std::string session_cache::_scoped_key(std::uint64_t context_id, std::string_view key) {
+    // The key is first, so that erase() can find the sessions of every context by prefix
+    std::string ret{key};
+    ret.push_back('\0');
+    ret += std::to_string(context_id);
+    return ret;
+}
+
+std::size_t session_cache::size() const noexcept {
+    std::lock_guard lk{_mtx};
+    return _entries.size();
+}
+
+void session_cache::clear() noexcept {
+    std::lock_guard lk{_mtx};
+    while (!_entries.empty()) {
+        _erase(_entries.begin());
+    }
+}
+
+void session_cache::erase(std::string_view key) noexcept {
+    std::lock_guard lk{_mtx};
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        std::string_view scoped = it->first;
+        auto             next   = std::next(it);
+        if (scoped.size() > key.size() && scoped.substr(0, key.size()) == key
+            && scoped[key.size()] == '\0') {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+void session_cache::put(std::uint64_t context_id, std::string_view key, void* ssl_session) {
+    auto            scoped = _scoped_key(context_id, key);
+    std::lock_guard lk{_mtx};
+    auto            found = _index.find(scoped);
+    if (found != _index.end()) {
+        _erase(found->second);
+    }
+    if (_max_size == 0) {
+        ::SSL_SESSION_free(SESSION_PTR(ssl_session));
+        return;
+    }
+    while (_entries.size() >= _max_size) {
+        // The back of the list is the least recently used
+        _erase(std::prev(_entries.end()));
+    }
+    _entries.emplace_front(std::move(scoped), ssl_session);
+    try {
+        // The key of the index refers to the string within the list entry
+        _index.emplace(_entries.front().first, _entries.begin());
+    } catch (...) {
+        // The caller keeps its reference to the session
+        _entries.pop_front();
+        throw;
+    }
+}
+
+void* session_cache::get(std::uint64_t context_id, std::string_view key) {
+    auto            scoped = _scoped_key(context_id, key);
+    std::lock_guard lk{_mtx};
+    auto            found = _index.find(scoped);
+    if (found == _index.end()) {
+        return nullptr;
+    }
+    auto it   = found->second;
+    auto sess = SESSION_PTR(it->second);
+    if (!::SSL_SESSION_is_resumable(sess)) {
+        _erase(it);
+        return nullptr;
+    }
+    ::SSL_SESSION_up_ref(sess);
+    if (::SSL_SESSION_get_protocol_version(sess) >= TLS1_3_VERSION) {
+        // TLS 1.3 tickets are single-use. The server will give us a new one.
+        _erase(it);
+    } else {
+        _entries.splice(_entries.begin(), _entries, it);
+    }
+    return sess;
+}
+
+void detail::attach_session_cache(void* ssl_ctx, session_cache* cache) noexcept {
+    auto ctx = static_cast<::SSL_CTX*>(ssl_ctx);
+    ::SSL_CTX_set_ex_data(ctx, ctx_cache_index(), cache);
+    if (cache && !::SSL_CTX_get_ex_data(ctx, ctx_id_index())) {
+        static std::atomic<std::uintptr_t> next_id{1};
+        ::SSL_CTX_set_ex_data(ctx,
+                              ctx_id_index(),
+                              reinterpret_cast<void*>(next_id.fetch_add(1)));
+    }
+    if (cache) {
+        // Our cache replaces OpenSSL's internal cache
+        ::SSL_CTX_set_session_cache_mode(ctx,
+                                         SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        ::SSL_CTX_sess_set_new_cb(ctx, &on_new_session);
+    } else {
+        ::SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        ::SSL_CTX_sess_set_new_cb(ctx, nullptr);
+    }
+}
+
+void detail::set_session_key(void* ssl_ptr, std::string_view key) {
+    auto ssl      = static_cast<::SSL*>(ssl_ptr);
+    auto key_copy = std::make_unique<std::string>(key);
+    auto prev     = static_cast<std::string*>(::SSL_get_ex_data(ssl, ssl_key_index()));
+    if (::SSL_set_ex_data(ssl, ssl_key_index(), key_copy.get()) != 1) {
+        throw std::bad_alloc();
+    }
+    key_copy.release();
+    delete prev;
+
+    auto cache = cache_of(ssl);
+    if (!cache) {
+        return;
+    }
+    if (auto sess = SESSION_PTR(cache->get(context_id_of(ssl), key))) {
+        ::SSL_set_session(ssl, sess);
+        ::SSL_SESSION_free(sess);
+    }
+}
+
+std::string_view detail::get_session_key(const void* ssl) noexcept {
+    auto key = static_cast<std::string*>(
+        ::SSL_get_ex_data(static_cast<const ::SSL*>(ssl), ssl_key_index()));
+    return key ? std::string_view(*key) : std::string_view();
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <neo/io/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace neo::ssl {
+
+/**
+ * @brief A client-side cache of TLS sessions, keyed by the server that issued
+ * them (e.g. "host:port").
+ *
+ * Attach a cache to a client context with context::set_session_cache(). Each
+ * engine created against the context with a session key will then offer a
+ * cached session to the server, and will store the sessions that the server
+ * gives it. ssl::stream keys its sessions automatically with the server name
+ * and the peer's port.
+ *
+ * A cache may be shared by many contexts and threads. Sessions are kept
+ * separately for each context: A session is only offered by the context that
+ * received it, since resuming a session skips verifying the server, and
+ * another context may verify more strictly. When full, the least recently used
+ * session is evicted. TLS 1.3 sessions are removed when they are used, since a
+ * ticket should only be offered once.
+ *
+ * OpenSSL will not resume a session from a connection that was not shut down
+ * cleanly, so call shutdown() on connections before they are destroyed.
+ */
+class NEO_IO_OPENSSL_API_ATTR session_cache {
+    // Each entry owns a reference to an SSL_SESSION. Its key is scoped to a context.
+    using entry_list = std::list<std::pair<std::string, void*>>;
+
+    mutable std::mutex                                         _mtx;
+    std::size_t                                                _max_size;
+    entry_list                                                 _entries;
+    std::unordered_map<std::string_view, entry_list::iterator> _index;
+
+    void _erase(entry_list::iterator it) noexcept;
+
+    static std::string _scoped_key(std::uint64_t context_id, std::string_view key);
+
+public:
+    explicit session_cache(std::size_t max_size = 1024) noexcept
+        : _max_size(max_size) {}
+    ~session_cache() { clear(); }
+
+    session_cache(const session_cache&) = delete;
+    session_cache& operator=(const session_cache&) = delete;
+
+    /// The number of sessions held in the cache
+    std::size_t size() const noexcept;
+
+    /// Remove all sessions from the cache
+    void clear() noexcept;
+
+    /// Remove the sessions for the given key, from every context
+    void erase(std::string_view key) noexcept;
+
+    /**
+     * @brief Store a session for the given key and context, replacing any
+     * existing session. Takes ownership of the caller's reference to
+     * `ssl_session`, unless an exception is thrown.
+     */
+    void put(std::uint64_t context_id, std::string_view key, void* ssl_session);
+
+    /**
+     * @brief Obtain the session for the given key and context, or `nullptr`.
+     * The caller receives a new reference to the session, and must free it.
+     */
+    [[nodiscard]] void* get(std::uint64_t context_id, std::string_view key);
+};
+
+namespace detail {
+
+/**
+ * Use the cache for the client sessions of an SSL_CTX. `cache` may be null.
+ * The SSL_CTX is given an ID, unique within the process, that scopes its
+ * sessions within the cache.
+ */
+void attach_session_cache(void* ssl_ctx, session_cache* cache) noexcept;
+
+/**
+ * Set the session key of an SSL object, and offer the cached session for that
+ * key (if any) to the server.
+ */
+void set_session_key(void* ssl, std::string_view key);
+
+/// Get the session key of an SSL object, or an empty string
+std::string_view get_session_key(const void* ssl) noexcept;
+
+}  // namespace detail
+
+}  // namespace neo::ssl
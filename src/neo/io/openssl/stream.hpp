@@ -1,14 +1,24 @@
 #pragma once
 
 #include "./engine.hpp"
+#include <neo/io/concepts/layered.hpp>
 #include <neo/io/concepts/stream.hpp>
 #include <neo/io/stream/buffers.hpp>
+#include <neo/io/stream/file.hpp>
+#include <neo/io/stream/socket.hpp>
 #include <neo/io/write.hpp>
 
+#include <neo/platform.hpp>
 #include <neo/string_io.hpp>
 
 #include <neo/io/config.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <new>
+#include <string>
+
 namespace neo::ssl {
 
 template <read_write_stream Inner>
@@ -29,12 +39,37 @@ private:
         _eng.output().rebind_stream(_inner);
     }
 
+    void _default_session_key() noexcept {
+        if constexpr (std::same_as<lowest_layer_t<Inner>, socket>) {
+            auto name = _eng.server_name();
+            if (name.empty() || !_eng.session_key().empty()) {
+                return;
+            }
+            try {
+                std::error_code ec;
+                auto            port = lowest_layer(next_layer()).peer_address(ec).port();
+                if (!ec) {
+                    _eng.set_session_key(std::string(name) + ":" + std::to_string(port));
+                }
+            } catch (const std::bad_alloc&) {
+                // Without a key, the session is not cached. The handshake itself is unaffected.
+            }
+        }
+    }
+
 public:
     stream() = default;
 
     explicit stream(context& ctx, Inner&& inner)
         : _inner(NEO_FWD(inner))
-        , _eng(ctx, _bufs_t{_inner}, _bufs_t{_inner}) {}
+        , _eng(ctx, _bufs_t{_inner}, _bufs_t{_inner}) {
+        // Read at least one whole record from the next layer at a time, and more during bulk
+        // transfers.
+        auto& read_opts    = _eng.input().read_options();
+        read_opts.min_fill = _engine_t::max_ciphertext_record_size;
+        read_opts.max_fill = _engine_t::max_ciphertext_record_size * 4;
+        read_opts.adaptive = true;
+    }
 
     stream(stream&& other) noexcept
         : _inner(NEO_FWD(other._inner))
@@ -56,13 +91,144 @@ public:
         _rebind_io();
     }
 
-    void connect() { _eng.connect(); }
-    void connect(std::error_code& ec) noexcept { _eng.connect(ec); }
+    /**
+     * @brief Perform the client-side handshake.
+     *
+     * If set_server_name() was called and the lowest layer is a socket, the
+     * connection is keyed in the context's session cache (if any) by the
+     * server name and the peer's port, unless set_session_key() was called.
+     */
+    void connect() {
+        _default_session_key();
+        _eng.connect();
+    }
+    void connect(std::error_code& ec) noexcept {
+        _default_session_key();
+        _eng.connect(ec);
+    }
+
+    void accept() { _eng.accept(); }
+    void accept(std::error_code& ec) noexcept { _eng.accept(ec); }
+
+    void set_server_name(const std::string& name) { _eng.set_server_name(name); }
+    void set_server_name(const std::string& name, std::error_code& ec) noexcept {
+        _eng.set_server_name(name, ec);
+    }
 
     void shutdown() { _eng.shutdown(); }
     void shutdown(std::error_code& ec) noexcept { _eng.shutdown(ec); }
 
-    auto write_some(const_buffer cbuf) noexcept { return _eng.write_some(cbuf); }
+    /**
+     * @brief Access the buffers between the engine and the next layer, e.g. to
+     * set the write_buffer_options of the output.
+     */
+    auto& input_buffers() noexcept { return _eng.input(); }
+    auto& output_buffers() noexcept { return _eng.output(); }
+
+    /**
+     * @brief Whether input has been received from the next layer that has not
+     * been read from this stream, either as ciphertext in input_buffers() or
+     * within OpenSSL. A closed connection's close_notify may be held here.
+     */
+    bool has_buffered_input() noexcept {
+        return _eng.input().io_buffers().available() != 0 || _eng.has_pending_input();
+    }
+
+    /**
+     * @brief Write any output that is buffered in output_buffers() to the next layer.
+     */
+    void flush() { _eng.flush(); }
+    void flush(std::error_code& ec) noexcept { _eng.flush(ec); }
+
+    /**
+     * @brief Perform TLS directly on the lowest layer socket, and allow
+     * OpenSSL to offload record encryption to the kernel (kTLS). Must be
+     * called before connect().
+     *
+     * Reads and writes then go straight to the socket. Any layers between
+     * this stream and the socket are bypassed, and must not hold buffered
+     * data.
+     *
+     * @returns `false` if kTLS is not available, in which case the stream
+     * continues to encrypt through the next layer as usual.
+     */
+    bool enable_ktls(std::error_code& ec) noexcept
+        requires std::same_as<lowest_layer_t<Inner>, socket> {
+#if NEO_OS_IS_UNIX_LIKE
+        return _eng.enable_ktls(native_handle_of(lowest_layer(next_layer())), ec);
+#else
+        (void)ec;
+        return false;
+#endif
+    }
+    bool enable_ktls() requires std::same_as<lowest_layer_t<Inner>, socket> {
+        return enable_ktls("Failed to enable kernel TLS offload"_ec_throw);
+    }
+
+    /**
+     * @brief Set the fewest bytes read from the next layer at a time. See
+     * engine_base::set_input_chunk_size().
+     */
+    void set_input_chunk_size(std::size_t n) noexcept {
+        _eng.set_input_chunk_size(n);
+        _eng.input().read_options().min_fill = n;
+    }
+
+    void set_session_key(std::string_view key) { _eng.set_session_key(key); }
+    auto session_key() const noexcept { return _eng.session_key(); }
+    bool session_reused() const noexcept { return _eng.session_reused(); }
+
+    /// Whether records sent on this stream are encrypted by the kernel
+    bool ktls_send() const noexcept { return _eng.ktls_send(); }
+    /// Whether records received on this stream are decrypted by the kernel
+    bool ktls_recv() const noexcept { return _eng.ktls_recv(); }
+
+    /**
+     * @brief Send `len` bytes of the file, beginning at `offset`, without
+     * modifying the file position.
+     *
+     * If kTLS is active for sending, the file is sent with SSL_sendfile() and
+     * is never copied into userspace. Otherwise, the file is read and
+     * encrypted in userspace one record at a time.
+     */
+    basic_transfer_result sendfile(file_stream& file, std::uint64_t offset, std::size_t len) {
+#if NEO_OS_IS_UNIX_LIKE
+        if (_eng.ktls_send()) {
+            return _eng.sendfile(native_handle_of(file), offset, len);
+        }
+#endif
+        std::array<std::byte, 1024 * 16> buf;
+        basic_transfer_result            ret;
+        while (ret.bytes_transferred < len) {
+            auto want   = (std::min)(buf.size(), len - ret.bytes_transferred);
+            auto pos    = offset + ret.bytes_transferred;
+            auto read_r = file.read_some_at(pos, mutable_buffer(buf.data(), want));
+            if (transfer_errant(read_r)) {
+                ret.ec = read_r.error();
+                break;
+            }
+            if (read_r.bytes_transferred == 0) {
+                // EOF
+                break;
+            }
+            auto write_r = neo::write(*this, const_buffer(buf.data(), read_r.bytes_transferred));
+            ret.bytes_transferred += write_r.bytes_transferred;
+            if (transfer_errant(write_r)) {
+                ret.ec = write_r.error();
+                break;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Write plaintext to the stream. Buffer sequences are gathered into
+     * as few TLS records as possible.
+     */
+    template <buffer_range Bufs>
+    auto write_some(Bufs&& bufs) noexcept {
+        return _eng.write_some(bufs);
+    }
     auto read_some(mutable_buffer mbuf) noexcept { return _eng.read_some(mbuf); }
 };
 
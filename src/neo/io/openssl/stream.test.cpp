@@ -1,14 +1,37 @@
 #include "./stream.hpp"
 
+#include "./openssl.hpp"
+
+#include "../../../../testing/certs.hpp"
+#include "../../../../testing/socket_pair.hpp"
+
+#include <neo/io/read.hpp>
+#include <neo/io/stream/connection_pool.hpp>
+#include <neo/io/stream/listener.hpp>
 #include <neo/io/stream/socket.hpp>
+#include <neo/io/write.hpp>
 
+#include <neo/as_buffer.hpp>
 #include <neo/test_concept.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <csignal>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #if NEO_FeatureIsEnabled(neo_io, OpenSSL_Support)
 
 NEO_TEST_CONCEPT(neo::read_write_stream<neo::ssl::stream<neo::proto_read_write_stream>>);
+NEO_TEST_CONCEPT(neo::vectored_write_stream<neo::ssl::stream<neo::proto_read_write_stream>>);
 
 TEST_CASE("Create an OpenSSL stream") {
     auto sock = neo::socket::open_connected(neo::address::resolve("www.google.com", "443"),
@@ -32,4 +55,422 @@ TEST_CASE("Create an OpenSSL stream") {
     CHECK(buf.starts_with("HTTP/1.1"));
 }
 
+namespace {
+
+using namespace neo::ssl::testing;
+
+/// Echo back the first four bytes that the client sends
+void echo_ping(neo::ssl::stream<neo::socket>& tls) {
+    std::string buf(4, '\0');
+    neo::read(tls, neo::as_buffer(buf));
+    neo::write(tls, neo::as_buffer(buf));
+}
+
+/**
+ * Accept TLS connections in a background thread, one at a time, and handle
+ * each with the given function.
+ */
+class tls_server {
+public:
+    using handler_fn = std::function<void(neo::ssl::stream<neo::socket>&)>;
+
+private:
+    neo::listener      _listener{neo::address::resolve("127.0.0.1", "0")};
+    std::exception_ptr _error;
+    std::thread        _thread;
+
+    void _run(neo::ssl::context& ctx, int n_conns, const handler_fn& handler) {
+        try {
+            for (auto i = 0; i < n_conns; ++i) {
+                neo::ssl::stream tls{ctx, neo::testing::accept_blocking(_listener)};
+                tls.accept();
+                handler(tls);
+                // Sessions are only resumable if the connection is cleanly shut down
+                tls.shutdown();
+            }
+        } catch (...) {
+            _error = std::current_exception();
+        }
+    }
+
+public:
+    explicit tls_server(neo::ssl::context& ctx, int n_conns = 1, handler_fn handler = echo_ping)
+        : _thread([this, &ctx, n_conns, handler] { _run(ctx, n_conns, handler); }) {
+#if defined(SIGPIPE)
+        // The client may hang up before our close_notify is sent
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+    }
+
+    ~tls_server() {
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    neo::address address() const { return _listener.local_address(); }
+
+    /// Wait for the server to finish, and rethrow any error that it encountered
+    void join() {
+        _thread.join();
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+};
+
+std::string ping(neo::ssl::stream<neo::socket>& tls) {
+    neo::write(tls, neo::const_buffer("ping"));
+    std::string buf(4, '\0');
+    auto        res = neo::read(tls, neo::as_buffer(buf));
+    INFO(res.error().message());
+    CHECK_FALSE(res.error());
+    return buf;
+}
+
+neo::ssl::context client_context_trusting(std::string_view cert) {
+    neo::ssl::context ctx{neo::ssl::protocol::tls_any, neo::ssl::role::client};
+    ctx.add_certificate_authority(cert);
+    ctx.set_verify_mode(neo::ssl::verify_mode::peer);
+    return ctx;
+}
+
+}  // namespace
+
+TEST_CASE("Accept a TLS connection") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    tls_server server{server_ctx};
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    auto sock       = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    SECTION("Through the engine") {}
+    SECTION("With kTLS requested") {
+        // Whether or not the system supports kTLS, the connection must work
+        tls.enable_ktls();
+    }
+    tls.connect();
+    CHECK(ping(tls) == "ping");
+    server.join();
+}
+
+TEST_CASE("Gather small writes into a single TLS record") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    tls_server server{server_ctx};
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    auto sock       = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    tls.connect();
+
+    tls.output_buffers().write_options().cork = true;
+    std::vector<neo::const_buffer> parts
+        = {neo::const_buffer("p"), neo::const_buffer("i"), neo::const_buffer("ng")};
+    auto res = neo::write(tls, parts);
+    CHECK(res.bytes_transferred == 4);
+    // A record has more than 20 bytes of overhead. One record for each part would be much larger.
+    CHECK(tls.output_buffers().pending_output() < 4 + 20 * 2);
+    tls.flush();
+
+    std::string buf(4, '\0');
+    neo::read(tls, neo::as_buffer(buf));
+    CHECK(buf == "ping");
+    server.join();
+}
+
+TEST_CASE("Read a bulk transfer") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+
+    std::string payload;
+    for (auto i = 0; payload.size() < 1024 * 1024; ++i) {
+        payload += std::to_string(i) + ",";
+    }
+    tls_server server{server_ctx, 1, [&](auto& tls) { neo::write(tls, neo::as_buffer(payload)); }};
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    auto sock       = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    CHECK(tls.input_buffers().read_options().min_fill
+          >= neo::ssl::engine_base::max_ciphertext_record_size);
+    tls.connect();
+
+    std::string buf(payload.size(), '\0');
+    auto        res = neo::read(tls, neo::as_buffer(buf));
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == payload.size());
+    CHECK(buf == payload);
+    server.join();
+}
+
+TEST_CASE("Load a certificate and key from files") {
+    neo::ssl::openssl_app_init init;
+
+    auto dir       = std::filesystem::temp_directory_path();
+    auto cert_path = (dir / "neo-io-test-cert.pem").string();
+    auto key_path  = (dir / "neo-io-test-key.pem").string();
+    std::ofstream{cert_path} << localhost_cert;
+    std::ofstream{key_path} << localhost_key;
+
+    neo::ssl::context server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain_file(cert_path);
+    server_ctx.use_private_key_file(key_path);
+    tls_server server{server_ctx};
+
+    neo::ssl::context client_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::client};
+    client_ctx.load_verify_file(cert_path);
+    client_ctx.set_verify_mode(neo::ssl::verify_mode::peer);
+    auto sock = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    tls.connect();
+    CHECK(ping(tls) == "ping");
+    server.join();
+
+    std::filesystem::remove(cert_path);
+    std::filesystem::remove(key_path);
+}
+
+TEST_CASE("Select a certificate by server name") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          other_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    other_ctx.use_certificate_chain(other_cert);
+    other_ctx.use_private_key(other_key);
+
+    neo::ssl::context server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    std::string requested_name;
+    server_ctx.set_sni_callback([&](std::string_view name) -> neo::ssl::context* {
+        requested_name = name;
+        return name == "other.example" ? &other_ctx : nullptr;
+    });
+    tls_server server{server_ctx};
+
+    // The client only trusts the other certificate, so the handshake only
+    // succeeds if the server selects it.
+    auto client_ctx = client_context_trusting(other_cert);
+    auto sock       = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    tls.set_server_name("other.example");
+    tls.connect();
+    CHECK(ping(tls) == "ping");
+    server.join();
+    CHECK(requested_name == "other.example");
+}
+
+TEST_CASE("Resume TLS sessions") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+
+    neo::ssl::server_session_options opts;
+    auto                             cache      = std::make_shared<neo::ssl::session_cache>();
+    auto                             client_ctx = client_context_trusting(localhost_cert);
+    client_ctx.set_session_cache(cache);
+
+    auto connect = [&](const tls_server& server) {
+        auto sock = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+        neo::ssl::stream tls{client_ctx, std::move(sock)};
+        tls.set_server_name("localhost");
+        tls.connect();
+        CHECK(ping(tls) == "ping");
+        // The server may have hung up already. That's okay: We've sent our close_notify.
+        std::error_code ec;
+        tls.shutdown(ec);
+        return tls.session_reused();
+    };
+
+    SECTION("With TLS 1.2 session IDs") {
+        opts.enable_tickets = false;
+        server_ctx.set_server_session_options(opts);
+        ::SSL_CTX_set_max_proto_version(static_cast<::SSL_CTX*>(client_ctx.c_ptr()),
+                                        TLS1_2_VERSION);
+    }
+    SECTION("With session tickets") { server_ctx.set_server_session_options(opts); }
+
+    tls_server server{server_ctx, 3};
+    CHECK_FALSE(connect(server));
+    CHECK(cache->size() == 1);
+    CHECK(connect(server));
+    CHECK(connect(server));
+    server.join();
+}
+
+TEST_CASE("Sessions are not shared between contexts") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+
+    auto cache = std::make_shared<neo::ssl::session_cache>();
+    // This context does not verify the server, so its sessions must not be
+    // resumed by a context that does
+    neo::ssl::context lax_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::client};
+    lax_ctx.set_session_cache(cache);
+    auto strict_ctx = client_context_trusting(localhost_cert);
+    strict_ctx.set_session_cache(cache);
+
+    auto connect = [&](const tls_server& server, neo::ssl::context& ctx) {
+        auto sock = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+        neo::ssl::stream tls{ctx, std::move(sock)};
+        tls.set_session_key("backend");
+        tls.connect();
+        CHECK(ping(tls) == "ping");
+        std::error_code ec;
+        tls.shutdown(ec);
+        return tls.session_reused();
+    };
+
+    tls_server server{server_ctx, 3};
+    CHECK_FALSE(connect(server, lax_ctx));
+    CHECK(cache->size() == 1);
+    CHECK_FALSE(connect(server, strict_ctx));
+    CHECK(connect(server, strict_ctx));
+    server.join();
+
+    cache->erase("backend");
+    CHECK(cache->size() == 0);
+}
+
+TEST_CASE("Do not resume sessions when the server disables them") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    neo::ssl::server_session_options opts;
+    opts.enable_cache   = false;
+    opts.enable_tickets = false;
+    server_ctx.set_server_session_options(opts);
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    client_ctx.set_session_cache(std::make_shared<neo::ssl::session_cache>());
+
+    tls_server server{server_ctx, 2};
+    for (auto i = 0; i < 2; ++i) {
+        auto sock = neo::socket::open_connected(server.address(), neo::socket::type::stream);
+        neo::ssl::stream tls{client_ctx, std::move(sock)};
+        tls.set_session_key("backend");
+        tls.connect();
+        CHECK(ping(tls) == "ping");
+        CHECK_FALSE(tls.session_reused());
+    }
+    server.join();
+}
+
+TEST_CASE("Reject invalid certificates and keys") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    std::error_code            ec;
+    ctx.use_certificate_chain("Not a certificate", ec);
+    CHECK(ec);
+    ec = {};
+    ctx.use_private_key("Not a key", ec);
+    CHECK(ec);
+    ec = {};
+    ctx.use_certificate_chain_file("/this/file/does/not/exist.pem", ec);
+    CHECK(ec);
+    // A key that does not match the certificate
+    ctx.use_certificate_chain(localhost_cert);
+    CHECK_THROWS_AS(ctx.use_private_key(other_key), std::system_error);
+}
+
+TEST_CASE("Reuse pooled TLS connections") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+    tls_server server{server_ctx, 1, [](auto& tls) {
+                          echo_ping(tls);
+                          echo_ping(tls);
+                      }};
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    neo::connection_pool_key key{server.address(), "localhost", &client_ctx};
+
+    neo::connection_pool<neo::ssl::stream<neo::socket>> pool;
+
+    auto connect = [&] {
+        auto sock = neo::socket::open_connected(key.addr, neo::socket::type::stream);
+        neo::ssl::stream tls{client_ctx, std::move(sock)};
+        tls.set_server_name(key.server_name);
+        tls.connect();
+        return tls;
+    };
+
+    for (auto i = 0; i < 2; ++i) {
+        auto tls = pool.acquire(key, connect);
+        CHECK(ping(tls) == "ping");
+        pool.release(key, std::move(tls));
+    }
+    CHECK(pool.get_stats().hits == 1);
+
+    // The server has shut down the connection, so it must not be reused
+    server.join();
+    CHECK_FALSE(pool.acquire(key));
+    CHECK(pool.get_stats().closed_dead == 1);
+}
+
+TEST_CASE("Pooled TLS connections with buffered input are not reused") {
+    neo::ssl::openssl_app_init init;
+    neo::ssl::context          server_ctx{neo::ssl::protocol::tls_any, neo::ssl::role::server};
+    server_ctx.use_certificate_chain(localhost_cert);
+    server_ctx.use_private_key(localhost_key);
+
+    neo::listener      lis{neo::address::resolve("127.0.0.1", "0")};
+    std::promise<void> released;
+    std::exception_ptr server_error;
+    std::thread        server{[&] {
+        try {
+            neo::ssl::stream tls{server_ctx, neo::testing::accept_blocking(lis)};
+            tls.accept();
+            echo_ping(tls);
+            tls.shutdown();
+            // Hold the socket open, so that only the TLS layer can see that the connection is
+            // closed
+            released.get_future().wait();
+        } catch (...) {
+            server_error = std::current_exception();
+        }
+    }};
+
+    auto client_ctx = client_context_trusting(localhost_cert);
+    neo::connection_pool_key key{lis.local_address(), "localhost", &client_ctx};
+    auto sock = neo::socket::open_connected(key.addr, neo::socket::type::stream);
+    neo::ssl::stream tls{client_ctx, std::move(sock)};
+    tls.set_server_name(key.server_name);
+    tls.connect();
+    CHECK(ping(tls) == "ping");
+    // Wait for the server's close_notify to be buffered, without reading it from the stream
+    for (auto i = 0; i < 100 && !tls.has_buffered_input(); ++i) {
+        if (!neo::io_detail::idle_socket_is_reusable(tls.next_layer())) {
+            tls.input_buffers().next(1);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    REQUIRE(tls.has_buffered_input());
+    // The socket alone looks idle
+    CHECK(neo::io_detail::idle_socket_is_reusable(tls.next_layer()));
+
+    neo::connection_pool<neo::ssl::stream<neo::socket>> pool;
+    pool.release(key, std::move(tls));
+    CHECK_FALSE(pool.acquire(key));
+    CHECK(pool.get_stats().closed_dead == 1);
+
+    released.set_value();
+    server.join();
+    if (server_error) {
+        std::rethrow_exception(server_error);
+    }
+}
+
 #endif
@@ -0,0 +1,207 @@
+#include "./reactor.hpp"
+
+#if __linux__
+
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+
+using namespace neo;
+
+namespace {
+
+std::uint32_t epoll_events_for(io_readiness interest) noexcept {
+    auto          is_set = test_flags(interest);
+    std::uint32_t events = 0;
+    if (is_set(io_readiness::readable)) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (is_set(io_readiness::writable)) {
+        events |= EPOLLOUT;
+    }
+    if (is_set(io_readiness::edge_triggered)) {
+        events |= EPOLLET;
+    }
+    return events;
+}
+
+io_readiness readiness_for(std::uint32_t events) noexcept {
+    auto ret = io_readiness::none;
+    if (events & (EPOLLIN | EPOLLPRI)) {
+        ret |= io_readiness::readable;
+    }
+    if (events & EPOLLOUT) {
+        ret |= io_readiness::writable;
+    }
+    if (events & EPOLLERR) {
+        ret |= io_readiness::error;
+    }
+    if (events & (EPOLLHUP | EPOLLRDHUP)) {
+        ret |= io_readiness::hangup;
+    }
+    return ret;
+}
+
+std::error_code last_error() noexcept { return std::error_code(errno, std::system_category()); }
+
+}  // namespace
+
+reactor::reactor() {
+    error_code_thrower err;
+    auto               r = create(err);
+    err("Failed to create a new reactor");
+    *this = std::move(*r);
+}
+
+std::optional<reactor> reactor::create(std::error_code& ec) noexcept {
+    auto fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (fd == -1) {
+        ec = last_error();
+        return std::nullopt;
+    }
+    return reactor{native_stream::from_native_handle(std::move(fd))};
+}
+
+void reactor::add(native_stream_handle hndl,
+                  io_readiness         interest,
+                  handler_type         handler,
+                  std::error_code&     ec) {
+    // Store the registration before epoll can refer to it, so that a failure
+    // to store it cannot leave epoll with a dangling pointer.
+    auto [it, inserted] = _registrations.emplace(
+        hndl, std::make_unique<registration>(registration{hndl, std::move(handler)}));
+    if (!inserted) {
+        ec = make_error_code(std::errc::file_exists);
+        return;
+    }
+
+    ::epoll_event ev = {};
+    ev.events        = epoll_events_for(interest);
+    ev.data.ptr      = it->second.get();
+    if (::epoll_ctl(_epoll.native_handle(), EPOLL_CTL_ADD, hndl, &ev) == -1) {
+        ec = last_error();
+        _registrations.erase(it);
+    }
+}
+
+void reactor::modify(native_stream_handle hndl,
+                     io_readiness         interest,
+                     std::error_code&     ec) noexcept {
+    auto found = _registrations.find(hndl);
+    if (found == _registrations.end()) {
+        ec = make_error_code(std::errc::no_such_file_or_directory);
+        return;
+    }
+    ::epoll_event ev = {};
+    ev.events        = epoll_events_for(interest);
+    ev.data.ptr      = found->second.get();
+    if (::epoll_ctl(_epoll.native_handle(), EPOLL_CTL_MOD, hndl, &ev) == -1) {
+        ec = last_error();
+    }
+}
+
+void reactor::remove(native_stream_handle hndl, std::error_code& ec) noexcept {
+    auto found = _registrations.find(hndl);
+    if (found == _registrations.end()) {
+        ec = make_error_code(std::errc::no_such_file_or_directory);
+        return;
+    }
+    // Failure is not fatal: The handle may have already been closed
+    if (::epoll_ctl(_epoll.native_handle(), EPOLL_CTL_DEL, hndl, nullptr) == -1) {
+        ec = last_error();
+    }
+    auto reg     = std::move(found->second);
+    reg->removed = true;
+    _registrations.erase(found);
+    if (_dispatching) {
+        // There may be pending events (or even a running handler) that refer
+        // to this registration. Keep it alive until dispatch completes.
+        try {
+            _retired.push_back(std::move(reg));
+        } catch (const std::bad_alloc&) {
+            // Leak it rather than risk a use-after-free
+            (void)reg.release();
+        }
+    }
+}
+
+std::size_t reactor::run_once(std::optional<std::chrono::milliseconds> timeout,
+                              std::error_code&                         ec) {
+    std::array<::epoll_event, 128> events;
+
+    int timeout_ms = -1;
+    if (timeout) {
+        // epoll_wait() takes an int, so longer timeouts are clamped
+        auto ms    = std::clamp<std::chrono::milliseconds::rep>(timeout->count(), 0, INT_MAX);
+        timeout_ms = static_cast<int>(ms);
+    }
+    int n_events   = ::epoll_wait(_epoll.native_handle(),
+                                events.data(),
+                                static_cast<int>(events.size()),
+                                timeout_ms);
+    if (n_events == -1) {
+        if (errno != EINTR) {
+            ec = last_error();
+        }
+        return 0;
+    }
+
+    std::size_t n_dispatched = 0;
+    _dispatching             = true;
+    try {
+        for (auto idx = 0; idx < n_events; ++idx) {
+            auto& ev  = events[static_cast<std::size_t>(idx)];
+            auto  reg = static_cast<registration*>(ev.data.ptr);
+            if (reg->removed) {
+                continue;
+            }
+            reg->handler(readiness_for(ev.events));
+            ++n_dispatched;
+        }
+    } catch (...) {
+        _dispatching = false;
+        _retired.clear();
+        throw;
+    }
+    _dispatching = false;
+    _retired.clear();
+    return n_dispatched;
+}
+
+#else
+
+using namespace neo;
+
+// The reactor is not available on this platform. All operations fail.
+
+reactor::reactor() {
+    throw std::system_error(make_error_code(std::errc::function_not_supported),
+                            "neo::reactor is not supported on this platform");
+}
+
+std::optional<reactor> reactor::create(std::error_code& ec) noexcept {
+    ec = make_error_code(std::errc::function_not_supported);
+    return std::nullopt;
+}
+
+void reactor::add(native_stream_handle, io_readiness, handler_type, std::error_code& ec) {
+    ec = make_error_code(std::errc::function_not_supported);
+}
+
+void reactor::modify(native_stream_handle, io_readiness, std::error_code& ec) noexcept {
+    ec = make_error_code(std::errc::function_not_supported);
+}
+
+void reactor::remove(native_stream_handle, std::error_code& ec) noexcept {
+    ec = make_error_code(std::errc::function_not_supported);
+}
+
+std::size_t reactor::run_once(std::optional<std::chrono::milliseconds>, std::error_code& ec) {
+    ec = make_error_code(std::errc::function_not_supported);
+    return 0;
+}
+
+#endif
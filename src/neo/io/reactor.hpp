@@ -0,0 +1,159 @@
+#pragma once
+
+#include <neo/io/stream/native.hpp>
+
+#include <neo/enum.hpp>
+#include <neo/error.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace neo {
+
+/**
+ * @brief Readiness conditions of a native stream.
+ *
+ * Used both to express interest when registering with a `reactor`, and to
+ * report the conditions that were observed.
+ */
+enum class io_readiness : unsigned {
+    none = 0,
+
+    /// The stream has data available to read, or an EOF is pending
+    readable = 1,
+    /// The stream has room available to write
+    writable = 1 << 1,
+    /// An error condition is pending on the stream. Always reported.
+    error = 1 << 2,
+    /// The peer has hung up. Always reported.
+    hangup = 1 << 3,
+
+    /// (Interest only) Request edge-triggered rather than level-triggered notification
+    edge_triggered = 1 << 4,
+};
+
+NEO_DECL_ENUM_BITOPS(io_readiness);
+
+/**
+ * @brief A readiness-based event demultiplexer for native streams.
+ *
+ * Streams are registered with a set of readiness conditions and a handler.
+ * Each call to run_once() waits for some registered streams to become ready
+ * and invokes their handlers with the readiness that was observed. This allows
+ * a single thread to drive a great many connections.
+ *
+ * Registered streams should be placed in non-blocking mode, and the results of
+ * their read_some()/write_some() checked for `would_block()`.
+ *
+ * The reactor is backed by epoll() and is only available on Linux. It is not
+ * thread-safe: Registration and dispatch should occur on the same thread.
+ * Handlers may safely add(), modify(), and remove() registrations (including
+ * their own) while being dispatched.
+ */
+class reactor {
+public:
+    using handler_type = std::function<void(io_readiness)>;
+
+private:
+    struct registration {
+        native_stream_handle handle;
+        handler_type         handler;
+        bool                 removed = false;
+    };
+
+    /// The epoll file descriptor
+    native_stream _epoll;
+
+    std::unordered_map<native_stream_handle, std::unique_ptr<registration>> _registrations;
+
+    /// Registrations that were removed during dispatch. Cleared once dispatch completes.
+    std::vector<std::unique_ptr<registration>> _retired;
+    bool                                       _dispatching = false;
+
+    explicit reactor(native_stream&& epoll) noexcept
+        : _epoll(std::move(epoll)) {}
+
+public:
+    /**
+     * @brief Create a new reactor. Throws on failure.
+     */
+    reactor();
+
+    reactor(reactor&&) = default;
+    reactor& operator=(reactor&&) = default;
+
+    /**
+     * @brief Create a new reactor, or a nullopt in case of error.
+     */
+    static std::optional<reactor> create(std::error_code& ec) noexcept;
+
+    /**
+     * @brief Register the native handle `hndl` with the given interest and handler.
+     *
+     * The handle must not already be registered. The reactor does not take
+     * ownership of the handle: It must be removed before the handle is closed.
+     */
+    void add(native_stream_handle hndl,
+             io_readiness         interest,
+             handler_type         handler,
+             std::error_code&     ec);
+    void add(native_stream_handle hndl, io_readiness interest, handler_type handler) {
+        add(hndl, interest, std::move(handler), "Failed to register with reactor"_ec_throw);
+    }
+
+    /**
+     * @brief Register a stream object (native_stream, file_stream, socket, etc.)
+     */
+    template <typename Stream>
+    void add(Stream& strm, io_readiness interest, handler_type handler, std::error_code& ec) {
+        add(native_handle_of(strm), interest, std::move(handler), ec);
+    }
+    template <typename Stream>
+    void add(Stream& strm, io_readiness interest, handler_type handler) {
+        add(native_handle_of(strm), interest, std::move(handler));
+    }
+
+    /**
+     * @brief Change the readiness conditions of interest for a registered handle.
+     */
+    void modify(native_stream_handle hndl, io_readiness interest, std::error_code& ec) noexcept;
+    void modify(native_stream_handle hndl, io_readiness interest) {
+        modify(hndl, interest, "Failed to modify reactor registration"_ec_throw);
+    }
+
+    /**
+     * @brief Remove the registration of a handle. Its handler will not be invoked again.
+     */
+    void remove(native_stream_handle hndl, std::error_code& ec) noexcept;
+    void remove(native_stream_handle hndl) {
+        remove(hndl, "Failed to remove reactor registration"_ec_throw);
+    }
+
+    /**
+     * @brief Wait for registered handles to become ready, and dispatch their handlers.
+     *
+     * @param timeout The maximum amount of time to wait. If nullopt, waits
+     *      indefinitely. A zero timeout will only poll.
+     * @return The number of handlers that were invoked. Zero if the wait timed
+     *      out or was interrupted by a signal.
+     */
+    std::size_t run_once(std::optional<std::chrono::milliseconds> timeout,
+                         std::error_code&                         ec);
+    std::size_t run_once(std::optional<std::chrono::milliseconds> timeout = std::nullopt) {
+        return run_once(timeout, "Failed to wait for I/O readiness"_ec_throw);
+    }
+
+    /// The number of registered handles
+    std::size_t size() const noexcept { return _registrations.size(); }
+    bool        empty() const noexcept { return _registrations.empty(); }
+
+    /// The native handle of the underlying event queue
+    native_stream_handle native_handle() const noexcept { return _epoll.native_handle(); }
+};
+
+}  // namespace neo
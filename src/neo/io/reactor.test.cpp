@@ -0,0 +1,103 @@
+#include <neo/io/reactor.hpp>
+
+#include "../../../testing/pipe.hpp"
+
+#include <catch2/catch.hpp>
+
+#if __linux__
+
+#include <string>
+
+using neo::testing::make_pipe;
+
+TEST_CASE("Non-blocking reads report would_block") {
+    auto [in, out] = make_pipe();
+    in.set_nonblocking(true);
+
+    std::string buf;
+    buf.resize(16);
+    auto res = in.read_some(neo::mutable_buffer(buf));
+    CHECK(res.has_error());
+    CHECK(res.would_block());
+    CHECK(res.bytes_transferred == 0);
+
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("Hello")).has_error());
+    res = in.read_some(neo::mutable_buffer(buf));
+    CHECK_FALSE(res.has_error());
+    CHECK_FALSE(res.would_block());
+    CHECK(res.bytes_transferred == 5);
+}
+
+TEST_CASE("Dispatch readiness with a reactor") {
+    auto [in, out] = make_pipe();
+    in.set_nonblocking(true);
+
+    neo::reactor r;
+    std::string  got;
+    int          n_calls = 0;
+    r.add(in, neo::io_readiness::readable, [&](neo::io_readiness ready) {
+        ++n_calls;
+        CHECK((ready & neo::io_readiness::readable) == neo::io_readiness::readable);
+        std::string buf;
+        buf.resize(64);
+        auto res = in.read_some(neo::mutable_buffer(buf));
+        REQUIRE_FALSE(res.has_error());
+        got.append(buf.data(), res.bytes_transferred);
+    });
+    CHECK(r.size() == 1);
+
+    // Nothing is ready yet
+    CHECK(r.run_once(std::chrono::milliseconds(0)) == 0);
+    CHECK(n_calls == 0);
+
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("Ready!")).has_error());
+    CHECK(r.run_once(std::chrono::milliseconds(1000)) == 1);
+    CHECK(n_calls == 1);
+    CHECK(got == "Ready!");
+
+    // Level-triggered: Nothing left to read, so no more events
+    CHECK(r.run_once(std::chrono::milliseconds(0)) == 0);
+
+    r.remove(neo::native_handle_of(in));
+    CHECK(r.empty());
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("Ignored")).has_error());
+    CHECK(r.run_once(std::chrono::milliseconds(0)) == 0);
+}
+
+TEST_CASE("Failed registrations are not kept") {
+    auto [in, out] = make_pipe();
+    neo::reactor r;
+    r.add(in, neo::io_readiness::readable, [](auto) {});
+
+    std::error_code ec;
+    r.add(in, neo::io_readiness::readable, [](auto) {}, ec);
+    CHECK(ec == std::errc::file_exists);
+    CHECK(r.size() == 1);
+
+    // epoll cannot wait on a closed handle
+    ec = {};
+    r.add(neo::native_stream_handle(-1), neo::io_readiness::readable, [](auto) {}, ec);
+    CHECK(ec);
+    CHECK(r.size() == 1);
+
+    // Timeouts too long for epoll_wait() are clamped rather than wrapped
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("x")).has_error());
+    CHECK(r.run_once(std::chrono::hours(24 * 365 * 100)) == 1);
+}
+
+TEST_CASE("Remove a registration from within its own handler") {
+    auto [in, out] = make_pipe();
+
+    neo::reactor r;
+    int          n_calls = 0;
+    r.add(in, neo::io_readiness::readable, [&](neo::io_readiness) {
+        ++n_calls;
+        r.remove(neo::native_handle_of(in));
+    });
+    REQUIRE_FALSE(out.write_some(neo::const_buffer("data")).has_error());
+    CHECK(r.run_once(std::chrono::milliseconds(1000)) == 1);
+    CHECK(r.run_once(std::chrono::milliseconds(0)) == 0);
+    CHECK(n_calls == 1);
+}
+
+#endif
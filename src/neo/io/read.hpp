@@ -7,6 +7,8 @@
 
 #include <neo/const_buffer.hpp>
 
+#include <cstdint>
+
 namespace neo {
 
 /**
@@ -32,4 +34,32 @@ read_result_t<Stream> read(Stream& strm, Bufs&& bufs) noexcept {
     return read(strm, bufs, transfer_all);
 }
 
+/**
+ * Read from the given stream, beginning at the given offset, into the buffers
+ * until a completion condition is met. The stream position (if any) is not used.
+ *
+ * @param strm The stream to read from
+ * @param offset The offset within the stream at which to begin reading
+ * @param bufs The buffers that should receive the data
+ * @param cond The completion condition. Should return the number of bytes to be read from the
+ *      stream.
+ */
+template <random_access_read_stream                Stream,
+          mutable_buffer_range                     Bufs,
+          read_at_completion_condition_for<Stream> CompletionCondition>
+read_at_result_t<Stream, Bufs>
+read_at(Stream&& strm, std::uint64_t offset, Bufs&& bufs, CompletionCondition&& cond) noexcept {
+    auto use_buf_ranges = std::bool_constant<vectored_random_access_read_stream<Stream>>{};
+    return detail::do_io_op(bufs, cond, use_buf_ranges, [&](auto&& parts) {
+        auto res = strm.read_some_at(offset, parts);
+        offset += res.bytes_transferred;
+        return res;
+    });
+}
+
+template <random_access_read_stream Stream, mutable_buffer_range Bufs>
+read_at_result_t<Stream> read_at(Stream& strm, std::uint64_t offset, Bufs&& bufs) noexcept {
+    return read_at(strm, offset, bufs, transfer_all);
+}
+
 }  // namespace neo
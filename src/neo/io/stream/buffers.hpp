@@ -13,8 +13,78 @@
 #include <neo/ref.hpp>
 #include <neo/shifting_dynamic_buffer.hpp>
 
+#include <algorithm>
+
 namespace neo {
 
+/**
+ * @brief Control when data committed to a stream_io_buffers is written to the
+ * underlying stream.
+ *
+ * The default writes all data on every commit().
+ */
+struct write_buffer_options {
+    /**
+     * Committed data is held in the buffer until at least this many bytes are
+     * pending, and is then written with a single write().
+     */
+    std::size_t high_watermark = 0;
+    /**
+     * When the high watermark is crossed, write until no more than this many
+     * bytes remain pending. Should be less than the high watermark.
+     */
+    std::size_t low_watermark = 0;
+    /**
+     * Hold all committed data until flush() is called, regardless of the
+     * watermarks. Useful for request/response protocols, where a message is
+     * built from many small commits.
+     */
+    bool cork = false;
+};
+
+/**
+ * @brief Control how much data is read from the underlying stream when a
+ * stream_io_buffers needs more input.
+ */
+struct read_ahead_options {
+    /**
+     * The fewest bytes requested from the stream on each read. Small pulls
+     * from next() are then served from the buffer rather than each requiring
+     * a read from the stream. Zero (the default) reads only what next() asks
+     * for, so that no data is consumed from the stream before it is needed.
+     */
+    std::size_t min_fill = 0;
+    /**
+     * The most bytes that will be requested from the stream by adaptive
+     * growth. Does not limit the size given to next().
+     */
+    std::size_t max_fill = 1024 * 64;
+    /**
+     * Grow the read size while reads are filling the buffer, and shrink it
+     * again when they are not.
+     */
+    bool adaptive = false;
+    /**
+     * When next() is asked for more than is buffered, attempt to read the
+     * difference rather than returning only what is buffered. If the stream
+     * is non-blocking and has nothing ready, the buffered data is returned.
+     */
+    bool opportunistic = false;
+};
+
+/**
+ * @brief Adapt a stream to act as a buffer_source and/or buffer_sink.
+ *
+ * When used as a buffer_source, data is read from the stream according to the
+ * read_ahead_options, and may be read ahead of what was asked for by next().
+ *
+ * When used as a buffer_sink, data is written to the stream on commit()
+ * according to the write_buffer_options. If output is buffered, call flush()
+ * to write the remainder before the stream_io_buffers is destroyed.
+ *
+ * A single stream_io_buffers should be used for either input or output, but
+ * not both.
+ */
 template <typename Stream,
           dynamic_buffer Buffers
           = shifting_dynamic_buffer<dynamic_buffer_byte_container_adaptor<std::string>>>
@@ -25,8 +95,40 @@ public:
     using buffers_type = std::remove_cvref_t<Buffers>;
 
 private:
-    wrap_refs_t<Stream> _strm;
-    dynbuf_io<Buffers>  _io_bufs;
+    wrap_refs_t<Stream>  _strm;
+    dynbuf_io<Buffers>   _io_bufs;
+    write_buffer_options _write_opts;
+    read_ahead_options   _read_opts;
+    std::size_t          _fill_size = 0;
+
+    /// Write pending output until no more than `keep` bytes remain
+    constexpr void _write_pending(std::size_t keep) {
+        auto avail = _io_bufs.available();
+        if (avail <= keep) {
+            return;
+        }
+        auto write_res = write(stream(), _io_bufs.next(avail), transfer_exactly{avail - keep});
+        _io_bufs.consume(write_res.bytes_transferred);
+        throw_if_transfer_errant(write_res, "Failed write in stream_io_buffers");
+    }
+
+    /// Do a single read from the stream of at least `want` bytes
+    constexpr auto _fill(std::size_t want) {
+        auto fill     = (std::max)(want, (std::max)(_fill_size, _read_opts.min_fill));
+        auto read_res = stream().read_some(_io_bufs.prepare(fill));
+        _io_bufs.commit(read_res.bytes_transferred);
+        if (_read_opts.adaptive) {
+            auto nread = read_res.bytes_transferred;
+            auto floor = _read_opts.min_fill;
+            if (nread == fill) {
+                // The stream had at least as much as we asked for. Ask for more next time.
+                _fill_size = (std::max)(floor, (std::min)(fill * 2, _read_opts.max_fill));
+            } else if (nread < fill / 4) {
+                _fill_size = (std::max)(floor, fill / 2);
+            }
+        }
+        return read_res;
+    }
 
 public:
     constexpr stream_io_buffers() = default;
@@ -52,25 +154,44 @@ public:
         return _io_bufs.prepare(size);
     }
 
+    /// Access the options that control buffering of output
+    constexpr auto& write_options() noexcept { return _write_opts; }
+    constexpr auto& write_options() const noexcept { return _write_opts; }
+
     constexpr decltype(auto) commit(std::size_t size) requires(write_stream<stream_type>) {
         _io_bufs.commit(size);
-        auto write_res = write(stream(), _io_bufs.next(size));
-        _io_bufs.consume(write_res.bytes_transferred);
-        throw_if_transfer_errant(write_res, "Failed write in stream_io_buffers::commit()");
+        if (_write_opts.cork || _io_bufs.available() < _write_opts.high_watermark) {
+            return;
+        }
+        _write_pending(_write_opts.low_watermark);
     }
 
+    /**
+     * @brief Write all pending output to the stream.
+     */
+    constexpr void flush() requires(write_stream<stream_type>) { _write_pending(0); }
+
+    /// The number of bytes that have been committed but not yet written
+    constexpr std::size_t pending_output() const noexcept requires(write_stream<stream_type>) {
+        return _io_bufs.available();
+    }
+
+    /// Access the options that control reading ahead of input
+    constexpr auto& read_options() noexcept { return _read_opts; }
+    constexpr auto& read_options() const noexcept { return _read_opts; }
+
     constexpr decltype(auto) next(std::size_t size) requires(read_stream<stream_type>) {
-        if (_io_bufs.available() > size) {
-            return _io_bufs.next(size);
-        } else if (_io_bufs.available()) {
-            return _io_bufs.next(_io_bufs.available());
-        } else {
-            auto in_bufs  = _io_bufs.prepare(size);
-            auto read_res = stream().read_some(in_bufs);
-            _io_bufs.commit(read_res.bytes_transferred);
+        auto avail = _io_bufs.available();
+        if (avail == 0) {
+            auto read_res = _fill(size);
             throw_if_transfer_errant(read_res, "Failed read in stream_io_buffers::next()");
+        } else if (avail < size && _read_opts.opportunistic) {
+            auto read_res = _fill(size - avail);
+            if (!transfer_would_block(read_res)) {
+                throw_if_transfer_errant(read_res, "Failed read in stream_io_buffers::next()");
+            }
         }
-        return _io_bufs.next(size);
+        return _io_bufs.next((std::min)(size, _io_bufs.available()));
     }
 
     constexpr decltype(auto) consume(std::size_t size) noexcept requires(read_stream<stream_type>) {
@@ -10,7 +10,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <string_view>
+#include <vector>
 
 NEO_TEST_CONCEPT(neo::buffer_sink<neo::stream_io_buffers<neo::proto_write_stream>>);
 NEO_TEST_CONCEPT(neo::buffer_source<neo::stream_io_buffers<neo::proto_read_stream>>);
@@ -28,6 +31,67 @@ TEST_CASE("Create a buffer wrapper around a stream") {
     CHECK(str.size() == 55);
 }
 
+namespace {
+
+/// A string stream that counts the calls to write_some()
+struct counting_stream {
+    std::string str;
+    int         n_writes = 0;
+
+    neo::basic_transfer_result write_some(neo::const_buffer buf) noexcept {
+        ++n_writes;
+        return neo::dynbuf_stream(neo::as_dynamic_buffer(str)).write_some(buf);
+    }
+};
+
+void commit_str(auto& bufs, std::string_view s) {
+    auto out = bufs.prepare(s.size());
+    std::memcpy(out.data(), s.data(), s.size());
+    bufs.commit(s.size());
+}
+
+}  // namespace
+
+TEST_CASE("Buffer output until a high watermark") {
+    counting_stream        strm;
+    neo::stream_io_buffers bufs{strm};
+    bufs.write_options().high_watermark = 10;
+    bufs.write_options().low_watermark  = 2;
+
+    commit_str(bufs, "abc");
+    commit_str(bufs, "def");
+    CHECK(strm.n_writes == 0);
+    CHECK(bufs.pending_output() == 6);
+
+    // Cross the high watermark. Write everything except the low watermark.
+    commit_str(bufs, "ghijk");
+    CHECK(strm.n_writes == 1);
+    CHECK(strm.str == "abcdefghi");
+    CHECK(bufs.pending_output() == 2);
+
+    bufs.flush();
+    CHECK(strm.n_writes == 2);
+    CHECK(strm.str == "abcdefghijk");
+    CHECK(bufs.pending_output() == 0);
+
+    // Flushing with nothing pending does not write
+    bufs.flush();
+    CHECK(strm.n_writes == 2);
+}
+
+TEST_CASE("Cork output until flushed") {
+    counting_stream        strm;
+    neo::stream_io_buffers bufs{strm};
+    bufs.write_options().cork = true;
+    for (auto i = 0; i < 100; ++i) {
+        commit_str(bufs, "message part;");
+    }
+    CHECK(strm.n_writes == 0);
+    bufs.flush();
+    CHECK(strm.n_writes == 1);
+    CHECK(strm.str.size() == 1300);
+}
+
 TEST_CASE("Read from a file") {
     neo::file_stream this_file{__FILE__};
 
@@ -55,3 +119,103 @@ TEST_CASE("Read from a file with custom buffers") {
     CAPTURE(sview);
     CHECK(sview.find("#include") != sview.npos);
 }
+
+namespace {
+
+/// A read stream over a string that records the size of each read_some()
+struct counting_read_stream {
+    std::string_view         str;
+    std::vector<std::size_t> read_sizes{};
+    bool                     would_block = false;
+
+    neo::basic_transfer_result read_some(neo::mutable_buffer buf) noexcept {
+        read_sizes.push_back(buf.size());
+        if (would_block) {
+            return {0, std::make_error_code(std::errc::operation_would_block)};
+        }
+        auto n = (std::min)(buf.size(), str.size());
+        std::memcpy(buf.data(), str.data(), n);
+        str.remove_prefix(n);
+        return {n, {}};
+    }
+};
+
+}  // namespace
+
+TEST_CASE("By default, read only what is asked for") {
+    std::string            str = "Hello, world!";
+    counting_read_stream   strm{str};
+    neo::stream_io_buffers bufs{strm};
+
+    CHECK(std::string_view(bufs.next(5)) == "Hello");
+    CHECK(strm.read_sizes == std::vector<std::size_t>{5});
+    // The rest of the stream is left for another reader
+    CHECK(strm.str == ", world!");
+}
+
+TEST_CASE("Small reads are served from the read-ahead buffer") {
+    std::string            str(1000, 'a');
+    counting_read_stream   strm{str};
+    neo::stream_io_buffers bufs{strm};
+    bufs.read_options().min_fill = 4096;
+
+    std::size_t n_read = 0;
+    while (true) {
+        auto part = bufs.next(1);
+        if (part.size() == 0) {
+            break;
+        }
+        bufs.consume(part.size());
+        ++n_read;
+    }
+    CHECK(n_read == 1000);
+    // One read to fill the buffer, and one to observe EOF
+    CHECK(strm.read_sizes.size() == 2);
+    CHECK(strm.read_sizes[0] == 4096);
+}
+
+TEST_CASE("Adaptive read-ahead grows with the stream") {
+    std::string            str(1024 * 1024, 'a');
+    counting_read_stream   strm{str};
+    neo::stream_io_buffers bufs{strm};
+    bufs.read_options().min_fill = 1024;
+    bufs.read_options().max_fill = 8192;
+    bufs.read_options().adaptive = true;
+
+    for (auto i = 0; i < 6; ++i) {
+        bufs.consume(bufs.next(1).size());
+        bufs.consume(bufs.io_buffers().available());
+    }
+    CHECK(strm.read_sizes == std::vector<std::size_t>{1024, 2048, 4096, 8192, 8192, 8192});
+
+    // Short reads shrink the read size again
+    strm.str = "abc";
+    bufs.consume(bufs.next(1).size());
+    bufs.consume(bufs.io_buffers().available());
+    bufs.consume(bufs.next(1).size());
+    CHECK(strm.read_sizes.back() == 4096);
+}
+
+TEST_CASE("Opportunistic read-ahead") {
+    std::string            str = "Hello, world!";
+    counting_read_stream   strm{str};
+    neo::stream_io_buffers bufs{strm};
+    bufs.read_options().min_fill = 5;
+
+    auto part = bufs.next(5);
+    CHECK(std::string_view(part) == "Hello");
+    // Without opportunistic reads, we only get what is buffered
+    bufs.consume(2);
+    CHECK(std::string_view(bufs.next(5)) == "llo");
+    CHECK(strm.read_sizes.size() == 1);
+
+    bufs.read_options().opportunistic = true;
+    CHECK(std::string_view(bufs.next(5)) == "llo, ");
+    CHECK(strm.read_sizes.size() == 2);
+
+    // A stream with no data ready gives us what is already buffered
+    bufs.consume(4);
+    strm.would_block = true;
+    CHECK(std::string_view(bufs.next(5)) == " wor");
+    CHECK(strm.read_sizes.size() == 3);
+}
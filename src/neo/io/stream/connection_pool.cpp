@@ -0,0 +1,28 @@
+#include "./connection_pool.hpp"
+
+#if NEO_OS_IS_UNIX_LIKE
+#include <poll.h>
+#elif NEO_OS_IS_WINDOWS
+#include <WS2tcpip.h>
+#endif
+
+using namespace neo;
+
+bool io_detail::idle_socket_is_reusable(const socket& sock) noexcept {
+#if NEO_OS_IS_UNIX_LIKE
+    ::pollfd pfd = {};
+    pfd.fd       = static_cast<int>(sock.native().native_handle());
+    pfd.events   = POLLIN;
+#if defined(POLLRDHUP)
+    pfd.events |= POLLRDHUP;
+#endif
+    auto rc = ::poll(&pfd, 1, 0);
+#elif NEO_OS_IS_WINDOWS
+    ::WSAPOLLFD pfd = {};
+    pfd.fd          = static_cast<::SOCKET>(sock.native().native_handle());
+    pfd.events      = POLLRDNORM;
+    auto rc         = ::WSAPoll(&pfd, 1, 0);
+#endif
+    // Readable, hung up, or in error: Either way, the connection is not idle.
+    return rc == 0;
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <neo/io/concepts/layered.hpp>
+#include <neo/io/stream/socket.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace neo {
+
+/**
+ * @brief Identifies the connections that may be used interchangeably in a
+ * connection_pool.
+ */
+struct connection_pool_key {
+    /// The address of the peer
+    address addr;
+    /// For TLS connections, the server name that was verified
+    std::string server_name;
+    /// For TLS connections, the ssl::context with which they were established
+    const void* context = nullptr;
+
+    bool operator==(const connection_pool_key&) const noexcept = default;
+};
+
+namespace io_detail {
+
+/**
+ * Whether an idle connection's socket may be used again: It must have nothing
+ * to read, since the peer should not send anything unprompted. Readable data
+ * means that the peer closed the connection, reset it, or that the connection
+ * was returned with an unread response.
+ */
+bool idle_socket_is_reusable(const socket& sock) noexcept;
+
+/**
+ * A layer that buffers input from the next layer (e.g. ssl::stream) reports
+ * whether it holds any with `has_buffered_input()`. Such input was received
+ * from the peer without being read, so it is never seen by polling the socket.
+ */
+// clang-format off
+template <typename T>
+concept reports_buffered_input = requires(T& layer) {
+    { layer.has_buffered_input() } noexcept -> std::convertible_to<bool>;
+};
+// clang-format on
+
+/// Whether an idle connection may be used again: No layer may hold unread input
+template <typename Conn>
+bool idle_connection_is_reusable(Conn& conn) noexcept {
+    if constexpr (reports_buffered_input<Conn>) {
+        if (conn.has_buffered_input()) {
+            return false;
+        }
+    }
+    if constexpr (layered<Conn>) {
+        return idle_connection_is_reusable(next_layer(conn));
+    } else {
+        return idle_socket_is_reusable(conn);
+    }
+}
+
+struct connection_pool_key_hash {
+    std::size_t operator()(const connection_pool_key& key) const noexcept {
+        auto h = key.addr.hash();
+        h ^= std::hash<std::string>{}(key.server_name) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<const void*>{}(key.context) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+}  // namespace io_detail
+
+/**
+ * @brief A thread-safe pool of idle connections, so that clients may reuse a
+ * connection rather than paying for a new TCP (and TLS) handshake.
+ *
+ * `Conn` is a movable connection whose lowest layer is a socket, e.g.
+ * `neo::socket` or `neo::ssl::stream<neo::socket>`.
+ *
+ * - acquire() returns the most recently released idle connection for the key
+ *   that has not expired and that passes a liveness check: The socket must
+ *   have nothing to read, and no layer may hold buffered input (see
+ *   io_detail::reports_buffered_input). Connections that fail the check are
+ *   closed.
+ * - release() returns a connection to the pool. Only release connections that
+ *   are ready for the next request: no response left unread, and no output
+ *   left buffered.
+ *
+ * The keys are divided among `options::n_shards` shards, each with its own
+ * lock, so that threads using different keys rarely contend. Connections are
+ * closed outside of the locks.
+ */
+template <typename Conn>
+class connection_pool {
+public:
+    using key_type = connection_pool_key;
+
+    struct options {
+        /// The most idle connections to keep for each key. The oldest are closed first.
+        std::size_t max_idle_per_key = 8;
+        /// The most idle connections to keep in total
+        std::size_t max_idle = 1024;
+        /// Idle connections older than this are closed rather than reused
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds(30);
+        /// The number of independently locked shards of the pool
+        std::size_t n_shards = 16;
+    };
+
+    struct stats {
+        /// acquire() calls that returned a pooled connection
+        std::uint64_t hits = 0;
+        /// acquire() calls that found no usable connection
+        std::uint64_t misses = 0;
+        /// Idle connections that were closed because they failed the liveness check
+        std::uint64_t closed_dead = 0;
+        /// Idle connections that were closed because they exceeded the idle timeout
+        std::uint64_t closed_expired = 0;
+        /// Released connections that were closed because the pool was full
+        std::uint64_t closed_full = 0;
+    };
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct idle_conn {
+        Conn              conn;
+        clock::time_point since;
+    };
+
+    using idle_list = std::deque<idle_conn>;
+
+    struct alignas(64) shard {
+        std::mutex                                                                mtx;
+        std::unordered_map<key_type, idle_list, io_detail::connection_pool_key_hash> idle;
+    };
+
+    options                  _opts;
+    std::unique_ptr<shard[]> _shards;
+    std::atomic<std::size_t> _n_idle{0};
+
+    std::atomic<std::uint64_t> _n_hits{0};
+    std::atomic<std::uint64_t> _n_misses{0};
+    std::atomic<std::uint64_t> _n_closed_dead{0};
+    std::atomic<std::uint64_t> _n_closed_expired{0};
+    std::atomic<std::uint64_t> _n_closed_full{0};
+
+    shard& _shard_for(const key_type& key) const noexcept {
+        return _shards[io_detail::connection_pool_key_hash{}(key) % _opts.n_shards];
+    }
+
+    /// Move the expired connections from the front of the list into `closing`
+    void _take_expired(idle_list& list, clock::time_point now, std::vector<Conn>& closing) {
+        while (!list.empty() && now - list.front().since >= _opts.idle_timeout) {
+            closing.push_back(std::move(list.front().conn));
+            list.pop_front();
+            _n_closed_expired.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// Pop the newest idle connection for the key, closing expired connections on the way
+    std::optional<Conn> _pop(const key_type& key) {
+        std::vector<Conn>   closing;
+        std::optional<Conn> ret;
+        auto&               sh = _shard_for(key);
+        std::unique_lock    lk{sh.mtx};
+        auto                it = sh.idle.find(key);
+        if (it == sh.idle.end()) {
+            return ret;
+        }
+        auto& list = it->second;
+        _take_expired(list, clock::now(), closing);
+        if (!list.empty()) {
+            ret.emplace(std::move(list.back().conn));
+            list.pop_back();
+        }
+        if (list.empty()) {
+            sh.idle.erase(it);
+        }
+        _n_idle.fetch_sub(closing.size() + (ret ? 1 : 0), std::memory_order_relaxed);
+        lk.unlock();
+        return ret;
+    }
+
+public:
+    connection_pool()
+        : connection_pool(options{}) {}
+
+    explicit connection_pool(options opts)
+        : _opts(opts) {
+        _opts.n_shards = (std::max)(_opts.n_shards, std::size_t(1));
+        _shards.reset(new shard[_opts.n_shards]);
+    }
+
+    connection_pool(const connection_pool&) = delete;
+    connection_pool& operator=(const connection_pool&) = delete;
+
+    /**
+     * @brief Take an idle connection for the key from the pool, or nullopt if
+     * there is none that can be reused.
+     */
+    std::optional<Conn> acquire(const key_type& key) {
+        while (auto conn = _pop(key)) {
+            if (io_detail::idle_connection_is_reusable(*conn)) {
+                _n_hits.fetch_add(1, std::memory_order_relaxed);
+                return conn;
+            }
+            _n_closed_dead.fetch_add(1, std::memory_order_relaxed);
+        }
+        _n_misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Take an idle connection for the key from the pool, or else create
+     * a new one by invoking `make()`.
+     */
+    template <std::invocable Make>
+    Conn acquire(const key_type& key, Make&& make) {
+        if (auto conn = acquire(key)) {
+            return std::move(*conn);
+        }
+        return make();
+    }
+
+    /**
+     * @brief Return a connection to the pool, to be reused by a later
+     * acquire() for the same key. If the pool is full, the connection is
+     * closed.
+     */
+    void release(const key_type& key, Conn&& conn) {
+        std::vector<Conn> closing;
+        auto&             sh = _shard_for(key);
+        std::unique_lock  lk{sh.mtx};
+        auto&             list = sh.idle[key];
+        const auto        now  = clock::now();
+        _take_expired(list, now, closing);
+        if (list.size() >= _opts.max_idle_per_key && !list.empty()) {
+            // Keep the newest connections
+            closing.push_back(std::move(list.front().conn));
+            list.pop_front();
+            _n_closed_full.fetch_add(1, std::memory_order_relaxed);
+        }
+        _n_idle.fetch_sub(closing.size(), std::memory_order_relaxed);
+        if (_opts.max_idle_per_key == 0
+            || _n_idle.load(std::memory_order_relaxed) >= _opts.max_idle) {
+            closing.push_back(std::move(conn));
+            _n_closed_full.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            list.push_back({std::move(conn), now});
+            _n_idle.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (list.empty()) {
+            sh.idle.erase(key);
+        }
+        lk.unlock();
+    }
+
+    /// Close the idle connections that have exceeded the idle timeout
+    void prune() {
+        const auto now = clock::now();
+        for (std::size_t i = 0; i < _opts.n_shards; ++i) {
+            std::vector<Conn> closing;
+            auto&             sh = _shards[i];
+            std::unique_lock  lk{sh.mtx};
+            for (auto it = sh.idle.begin(); it != sh.idle.end();) {
+                _take_expired(it->second, now, closing);
+                it = it->second.empty() ? sh.idle.erase(it) : std::next(it);
+            }
+            _n_idle.fetch_sub(closing.size(), std::memory_order_relaxed);
+            lk.unlock();
+        }
+    }
+
+    /// Close all idle connections
+    void clear() {
+        for (std::size_t i = 0; i < _opts.n_shards; ++i) {
+            decltype(shard::idle) closing;
+            auto&                 sh = _shards[i];
+            std::unique_lock      lk{sh.mtx};
+            closing.swap(sh.idle);
+            for (auto& pair : closing) {
+                _n_idle.fetch_sub(pair.second.size(), std::memory_order_relaxed);
+            }
+            lk.unlock();
+        }
+    }
+
+    /// The number of idle connections held in the pool
+    std::size_t idle_count() const noexcept { return _n_idle.load(std::memory_order_relaxed); }
+
+    stats get_stats() const noexcept {
+        stats ret;
+        ret.hits           = _n_hits.load(std::memory_order_relaxed);
+        ret.misses         = _n_misses.load(std::memory_order_relaxed);
+        ret.closed_dead    = _n_closed_dead.load(std::memory_order_relaxed);
+        ret.closed_expired = _n_closed_expired.load(std::memory_order_relaxed);
+        ret.closed_full    = _n_closed_full.load(std::memory_order_relaxed);
+        return ret;
+    }
+};
+
+/// A pool of plain socket connections
+using socket_pool = connection_pool<socket>;
+
+}  // namespace neo
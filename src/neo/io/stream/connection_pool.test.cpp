@@ -0,0 +1,134 @@
+#include <neo/io/stream/connection_pool.hpp>
+
+#include "../../../../testing/socket_pair.hpp"
+
+#include <neo/io/read.hpp>
+#include <neo/io/stream/listener.hpp>
+#include <neo/io/write.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct pool_fixture {
+    neo::listener            lis{neo::address::resolve("127.0.0.1", "0")};
+    neo::connection_pool_key key{lis.local_address()};
+    std::vector<neo::socket> server_ends;
+
+    neo::socket connect() {
+        auto [client, server] = neo::testing::make_socket_pair(lis);
+        server_ends.push_back(std::move(server));
+        return std::move(client);
+    }
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(pool_fixture, "Reuse a pooled connection") {
+    neo::socket_pool pool;
+    CHECK_FALSE(pool.acquire(key));
+
+    auto conn = pool.acquire(key, [&] { return connect(); });
+    auto addr = conn.local_address();
+    pool.release(key, std::move(conn));
+    CHECK(pool.idle_count() == 1);
+
+    // A different key does not share connections
+    CHECK_FALSE(pool.acquire({key.addr, "other.example"}));
+
+    auto again = pool.acquire(key);
+    REQUIRE(again);
+    CHECK(again->local_address() == addr);
+    CHECK(pool.idle_count() == 0);
+
+    // The connection still works
+    neo::write(*again, neo::const_buffer("ping"));
+    std::string buf(4, '\0');
+    neo::read(server_ends.back(), neo::mutable_buffer(buf));
+    CHECK(buf == "ping");
+
+    auto stats = pool.get_stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 3);
+}
+
+TEST_CASE_METHOD(pool_fixture, "Connections closed by the peer are not reused") {
+    neo::socket_pool pool;
+    pool.release(key, connect());
+    server_ends.clear();
+
+    CHECK_FALSE(pool.acquire(key));
+    CHECK(pool.get_stats().closed_dead == 1);
+}
+
+TEST_CASE_METHOD(pool_fixture, "Connections with unread data are not reused") {
+    neo::socket_pool pool;
+    pool.release(key, connect());
+    neo::write(server_ends.back(), neo::const_buffer("unexpected"));
+
+    CHECK_FALSE(pool.acquire(key));
+    CHECK(pool.get_stats().closed_dead == 1);
+}
+
+TEST_CASE_METHOD(pool_fixture, "Idle connections expire") {
+    neo::socket_pool pool{{.idle_timeout = std::chrono::milliseconds(0)}};
+    pool.release(key, connect());
+    CHECK_FALSE(pool.acquire(key));
+    CHECK(pool.get_stats().closed_expired == 1);
+
+    neo::socket_pool pool2{{.idle_timeout = std::chrono::milliseconds(20)}};
+    pool2.release(key, connect());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    pool2.prune();
+    CHECK(pool2.idle_count() == 0);
+}
+
+TEST_CASE_METHOD(pool_fixture, "Limit the number of idle connections") {
+    neo::socket_pool pool{{.max_idle_per_key = 2, .max_idle = 3}};
+    pool.release(key, connect());
+    pool.release(key, connect());
+    auto newest = connect();
+    auto addr   = newest.local_address();
+    pool.release(key, std::move(newest));
+    CHECK(pool.idle_count() == 2);
+    CHECK(pool.get_stats().closed_full == 1);
+
+    pool.release({key.addr, "a"}, connect());
+    pool.release({key.addr, "b"}, connect());
+    CHECK(pool.idle_count() == 3);
+    CHECK(pool.get_stats().closed_full == 2);
+
+    // The newest connection is handed out first
+    auto conn = pool.acquire(key);
+    REQUIRE(conn);
+    CHECK(conn->local_address() == addr);
+
+    pool.clear();
+    CHECK(pool.idle_count() == 0);
+}
+
+TEST_CASE_METHOD(pool_fixture, "Share a pool between threads") {
+    neo::socket_pool pool;
+    for (auto i = 0; i < 4; ++i) {
+        pool.release(key, connect());
+    }
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (auto j = 0; j < 1000; ++j) {
+                if (auto conn = pool.acquire(key)) {
+                    pool.release(key, std::move(*conn));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    CHECK(pool.idle_count() == 4);
+    CHECK(pool.get_stats().closed_dead == 0);
+}
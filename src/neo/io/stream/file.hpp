@@ -1,12 +1,14 @@
 #pragma once
 
 #include <neo/io/stream/native.hpp>
+#include <neo/io/stream/rw_flags.hpp>
 
 #include <neo/assert.hpp>
 #include <neo/buffer_range.hpp>
 #include <neo/enum.hpp>
 #include <neo/error.hpp>
 
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <system_error>
@@ -190,6 +192,30 @@ public:
         _strm.read_some(b);
     }
     { return _strm.read_some(b); }
+
+    /**
+     * @brief Write to the file at the given offset. The file position is not
+     * used, and is not modified, so several threads may write to different
+     * regions of the same file at once.
+     */
+    template <buffer_range Bufs>
+    auto write_some_at(std::uint64_t offset, Bufs&& b, rw_flags flags = rw_flags::none) noexcept
+        requires requires {
+        _strm.write_some_at(offset, b, flags);
+    }
+    { return _strm.write_some_at(offset, b, flags); }
+
+    /**
+     * @brief Read from the file at the given offset. The file position is not
+     * used, and is not modified, so several threads may read different regions
+     * of the same file at once.
+     */
+    template <mutable_buffer_range Bufs>
+    auto read_some_at(std::uint64_t offset, Bufs&& b, rw_flags flags = rw_flags::none) noexcept
+        requires requires {
+        _strm.read_some_at(offset, b, flags);
+    }
+    { return _strm.read_some_at(offset, b, flags); }
 };
 
 }  // namespace neo
@@ -2,12 +2,21 @@
 
 #include <neo/io/concepts/stream.hpp>
 #include <neo/io/read.hpp>
+#include <neo/io/write.hpp>
 
+#include <neo/platform.hpp>
 #include <neo/test_concept.hpp>
 
 #include <catch2/catch.hpp>
 
 NEO_TEST_CONCEPT(neo::read_write_stream<neo::file_stream>);
+NEO_TEST_CONCEPT(neo::random_access_read_stream<neo::file_stream>);
+NEO_TEST_CONCEPT(neo::random_access_write_stream<neo::file_stream>);
+#if !NEO_OS_IS_WINDOWS
+// Win32 handles only read and write a single buffer at an offset
+NEO_TEST_CONCEPT(neo::vectored_random_access_read_stream<neo::file_stream>);
+NEO_TEST_CONCEPT(neo::vectored_random_access_write_stream<neo::file_stream>);
+#endif
 
 TEST_CASE("Open a file") {
     neo::file_stream file("test.txt", neo::open_mode::write);
@@ -21,3 +30,50 @@ TEST_CASE("Open a file") {
     rbuf.resize(nread.bytes_transferred);
     CHECK(rbuf == "Hello, text!");
 }
+
+TEST_CASE("Positional reads and writes") {
+    neo::file_stream file("test-at.txt", neo::open_mode::write | neo::open_mode::read);
+    REQUIRE_FALSE(neo::write_at(file, 0, neo::const_buffer("0123456789")).error());
+    // Overwrite the middle, vectored
+    auto bufs = {neo::const_buffer("ab"), neo::const_buffer("cd")};
+    REQUIRE_FALSE(neo::write_at(file, 3, bufs).error());
+
+    std::string rbuf;
+    rbuf.resize(4);
+    auto res = neo::read_at(file, 2, neo::mutable_buffer(rbuf));
+    CHECK_FALSE(res.error());
+    CHECK(rbuf == "2abc");
+
+    // Reading past the end stops at EOF
+    rbuf.resize(20);
+    res = neo::read_at(file, 6, neo::mutable_buffer(rbuf));
+    CHECK_FALSE(res.error());
+    rbuf.resize(res.bytes_transferred);
+    CHECK(rbuf == "d789");
+
+    // The file position was never moved
+    rbuf.resize(3);
+    REQUIRE_FALSE(neo::read(file, neo::mutable_buffer(rbuf)).error());
+    CHECK(rbuf == "012");
+}
+
+#if __linux__
+TEST_CASE("Positional writes with flags") {
+    neo::file_stream file("test-at.txt", neo::open_mode::write | neo::open_mode::read);
+    auto res = file.write_some_at(0, neo::const_buffer("durable"), neo::rw_flags::dsync);
+    if (res.errn == EOPNOTSUPP) {
+        // The system does not support pwritev2()
+        return;
+    }
+    CHECK_FALSE(res.has_error());
+    CHECK(res.bytes_transferred == 7);
+
+    std::string rbuf;
+    rbuf.resize(7);
+    auto rres = file.read_some_at(0, neo::mutable_buffer(rbuf), neo::rw_flags::nowait);
+    if (!rres.would_block() && rres.errn != EOPNOTSUPP) {
+        CHECK_FALSE(rres.has_error());
+        CHECK(rbuf == "durable");
+    }
+}
+#endif
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <neo/io/concepts/layered.hpp>
+#include <neo/io/concepts/result.hpp>
+
+#include <neo/buffer_range.hpp>
+#include <neo/event.hpp>
+#include <neo/fwd.hpp>
+#include <neo/ref.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+
+namespace neo {
+
+namespace io_detail {
+
+template <typename Counter>
+constexpr void counter_add(Counter& c, std::uint64_t n) noexcept {
+    if constexpr (std::is_integral_v<Counter>) {
+        c += n;
+    } else {
+        c.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+template <typename Counter>
+constexpr std::uint64_t counter_load(const Counter& c) noexcept {
+    if constexpr (std::is_integral_v<Counter>) {
+        return c;
+    } else {
+        return c.load(std::memory_order_relaxed);
+    }
+}
+
+}  // namespace io_detail
+
+/**
+ * @brief A histogram of latencies with log-linear buckets.
+ *
+ * Each power-of-two range of nanoseconds is split into four equal buckets, so
+ * a recorded latency is known to within 25%. Latencies below four nanoseconds
+ * have a bucket each.
+ *
+ * `Counter` is std::uint64_t for a histogram used by a single thread, or
+ * std::atomic<std::uint64_t> for one that is updated by several threads.
+ */
+template <typename Counter>
+class basic_latency_histogram {
+public:
+    constexpr static unsigned    sub_bucket_bits  = 2;
+    constexpr static std::size_t sub_bucket_count = std::size_t(1) << sub_bucket_bits;
+    constexpr static std::size_t bucket_count     = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+private:
+    std::array<Counter, bucket_count> _buckets{};
+
+public:
+    /// The index of the bucket that holds the given number of nanoseconds
+    constexpr static std::size_t bucket_for(std::uint64_t ns) noexcept {
+        if (ns < sub_bucket_count) {
+            return static_cast<std::size_t>(ns);
+        }
+        const unsigned msb = static_cast<unsigned>(std::bit_width(ns)) - 1;
+        const auto     sub = (ns >> (msb - sub_bucket_bits)) - sub_bucket_count;
+        return (msb - sub_bucket_bits + 1) * sub_bucket_count + static_cast<std::size_t>(sub);
+    }
+
+    /// The smallest number of nanoseconds that is counted in the given bucket
+    constexpr static std::uint64_t bucket_lower_bound(std::size_t idx) noexcept {
+        if (idx < sub_bucket_count) {
+            return idx;
+        }
+        const auto msb = idx / sub_bucket_count + sub_bucket_bits - 1;
+        const auto sub = idx % sub_bucket_count;
+        return std::uint64_t(sub_bucket_count + sub) << (msb - sub_bucket_bits);
+    }
+
+    void record(std::chrono::nanoseconds latency) noexcept {
+        const auto ns = latency.count() < 0 ? 0 : static_cast<std::uint64_t>(latency.count());
+        io_detail::counter_add(_buckets[bucket_for(ns)], 1);
+    }
+
+    /// The number of latencies recorded in the given bucket
+    std::uint64_t count(std::size_t bucket) const noexcept {
+        return io_detail::counter_load(_buckets[bucket]);
+    }
+
+    /// The number of latencies recorded in all buckets
+    std::uint64_t total_count() const noexcept {
+        std::uint64_t ret = 0;
+        for (auto& b : _buckets) {
+            ret += io_detail::counter_load(b);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Estimate the latency below which the given fraction (0.0 to 1.0)
+     * of recorded latencies fall. Returns the lower bound of the bucket that
+     * holds that latency, or zero if nothing has been recorded.
+     */
+    std::chrono::nanoseconds percentile(double fraction) const noexcept {
+        const auto total = total_count();
+        if (total == 0) {
+            return {};
+        }
+        const auto rank = static_cast<std::uint64_t>(fraction * double(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t idx = 0; idx < bucket_count; ++idx) {
+            seen += count(idx);
+            if (seen >= rank) {
+                return std::chrono::nanoseconds(bucket_lower_bound(idx));
+            }
+        }
+        return std::chrono::nanoseconds(bucket_lower_bound(bucket_count - 1));
+    }
+
+    /// Add all counts from another histogram into this one
+    template <typename OtherCounter>
+    void merge(const basic_latency_histogram<OtherCounter>& other) noexcept {
+        for (std::size_t idx = 0; idx < bucket_count; ++idx) {
+            io_detail::counter_add(_buckets[idx], other.count(idx));
+        }
+    }
+};
+
+using latency_histogram        = basic_latency_histogram<std::uint64_t>;
+using shared_latency_histogram = basic_latency_histogram<std::atomic<std::uint64_t>>;
+
+enum class io_direction {
+    read,
+    write,
+};
+
+/**
+ * @brief Describes a single read_some() or write_some() on an
+ * instrumented_stream. Emitted with neo::emit() after the operation, if
+ * instrument_options::emit_events is set.
+ */
+struct ev_transfer {
+    /// The instrumented_stream that performed the operation
+    const void*              stream;
+    io_direction             direction;
+    std::size_t              bytes_requested;
+    std::size_t              bytes_transferred;
+    std::error_code          error;
+    bool                     would_block;
+    std::chrono::nanoseconds latency;
+};
+
+/**
+ * @brief Counters and latency histograms for the operations on one or more
+ * instrumented_streams.
+ *
+ * See latency_histogram regarding the `Counter` type. Use io_stats for a
+ * single stream, and shared_io_stats to aggregate streams on several threads.
+ * Updates to a shared_io_stats are lock-free and each counter is individually
+ * consistent, but a snapshot() taken while streams are active may observe
+ * some counters updated before others.
+ */
+template <typename Counter>
+struct basic_io_stats {
+    Counter read_calls{};
+    Counter write_calls{};
+    Counter bytes_read{};
+    Counter bytes_written{};
+    /// Successful calls that transferred fewer bytes than were requested
+    Counter short_reads{};
+    Counter short_writes{};
+    /// Reads that returned no data and no error (end-of-stream)
+    Counter eof_reads{};
+    /// Calls that failed because a non-blocking stream was not ready
+    Counter would_block{};
+    /// Calls that failed for any other reason
+    Counter errors{};
+
+    basic_latency_histogram<Counter> read_latency;
+    basic_latency_histogram<Counter> write_latency;
+
+    /**
+     * @brief Count a single operation. The latency is only recorded if
+     * `timed` is true.
+     */
+    void record(const ev_transfer& ev, bool timed) noexcept {
+        using io_detail::counter_add;
+        const bool is_read = ev.direction == io_direction::read;
+        counter_add(is_read ? read_calls : write_calls, 1);
+        counter_add(is_read ? bytes_read : bytes_written, ev.bytes_transferred);
+        if (ev.would_block) {
+            counter_add(would_block, 1);
+        } else if (ev.error) {
+            counter_add(errors, 1);
+        } else if (is_read && ev.bytes_transferred == 0 && ev.bytes_requested != 0) {
+            counter_add(eof_reads, 1);
+        } else if (ev.bytes_transferred < ev.bytes_requested) {
+            counter_add(is_read ? short_reads : short_writes, 1);
+        }
+        if (timed) {
+            (is_read ? read_latency : write_latency).record(ev.latency);
+        }
+    }
+
+    /// Add all counts from other stats into these
+    template <typename OtherCounter>
+    void merge(const basic_io_stats<OtherCounter>& other) noexcept {
+        using io_detail::counter_add;
+        using io_detail::counter_load;
+        counter_add(read_calls, counter_load(other.read_calls));
+        counter_add(write_calls, counter_load(other.write_calls));
+        counter_add(bytes_read, counter_load(other.bytes_read));
+        counter_add(bytes_written, counter_load(other.bytes_written));
+        counter_add(short_reads, counter_load(other.short_reads));
+        counter_add(short_writes, counter_load(other.short_writes));
+        counter_add(eof_reads, counter_load(other.eof_reads));
+        counter_add(would_block, counter_load(other.would_block));
+        counter_add(errors, counter_load(other.errors));
+        read_latency.merge(other.read_latency);
+        write_latency.merge(other.write_latency);
+    }
+
+    /// Copy the current counts into a (non-atomic) io_stats
+    basic_io_stats<std::uint64_t> snapshot() const noexcept {
+        basic_io_stats<std::uint64_t> ret;
+        ret.merge(*this);
+        return ret;
+    }
+};
+
+using io_stats        = basic_io_stats<std::uint64_t>;
+using shared_io_stats = basic_io_stats<std::atomic<std::uint64_t>>;
+
+struct instrument_options {
+    /// If false, operations are passed to the next layer without recording anything
+    bool enabled = true;
+    /// Time each operation for the latency histograms
+    bool time = true;
+    /// neo::emit() an ev_transfer after each operation
+    bool emit_events = false;
+    /// If non-null, operations are also counted here. Must outlive the stream.
+    shared_io_stats* aggregate = nullptr;
+};
+
+/**
+ * @brief A stream layer that counts the reads and writes that pass through
+ * it, and measures their latency.
+ *
+ * Each instrumented_stream keeps its own io_stats, and may also add to a
+ * shared_io_stats that aggregates many streams (see instrument_options).
+ * When disabled, the only cost of the layer is a single branch per operation.
+ */
+template <typename Stream>
+class instrumented_stream {
+    using clock = std::chrono::steady_clock;
+
+    wrap_refs_t<Stream> _strm;
+    instrument_options  _opts;
+    io_stats            _stats;
+
+    template <typename Bufs, typename Op>
+    auto _measure(io_direction dir, const Bufs& bufs, Op&& op) noexcept {
+        if (!_opts.enabled) {
+            return op();
+        }
+        const auto requested = buffer_size(bufs);
+        const auto start = _opts.time ? clock::now() : clock::time_point();
+        auto       res   = op();
+        const auto stop  = _opts.time ? clock::now() : clock::time_point();
+
+        const bool  errant = transfer_errant(res);
+        ev_transfer ev{this,
+                       dir,
+                       requested,
+                       res.bytes_transferred,
+                       errant ? std::error_code(res.error()) : std::error_code(),
+                       errant && transfer_would_block(res),
+                       stop - start};
+        _stats.record(ev, _opts.time);
+        if (_opts.aggregate) {
+            _opts.aggregate->record(ev, _opts.time);
+        }
+        if (_opts.emit_events) {
+            neo::emit(ev);
+        }
+        return res;
+    }
+
+public:
+    instrumented_stream() = default;
+
+    explicit instrumented_stream(Stream&& s, instrument_options opts = {})
+        : _strm(NEO_FWD(s))
+        , _opts(opts) {}
+
+    NEO_DECL_UNREF_GETTER(next_layer, _strm);
+
+    /// The counters for this stream
+    const io_stats& stats() const noexcept { return _stats; }
+    void            reset_stats() noexcept { _stats = io_stats(); }
+
+    /// The options may be changed at any time, e.g. to enable or disable recording
+    instrument_options&       options() noexcept { return _opts; }
+    const instrument_options& options() const noexcept { return _opts; }
+
+    template <buffer_range Bufs>
+    auto write_some(Bufs&& b) noexcept requires requires {
+        next_layer().write_some(b);
+    }
+    {
+        return _measure(io_direction::write, b, [&] {
+            return next_layer().write_some(b);
+        });
+    }
+
+    template <mutable_buffer_range Bufs>
+    auto read_some(Bufs&& b) noexcept requires requires {
+        next_layer().read_some(b);
+    }
+    {
+        return _measure(io_direction::read, b, [&] {
+            return next_layer().read_some(b);
+        });
+    }
+};
+
+template <typename Stream>
+instrumented_stream(Stream&&) -> instrumented_stream<Stream>;
+
+template <typename Stream>
+instrumented_stream(Stream&&, instrument_options) -> instrumented_stream<Stream>;
+
+}  // namespace neo
@@ -0,0 +1,133 @@
+#include <neo/io/stream/instrumented.hpp>
+
+#include "../../../../testing/pipe.hpp"
+
+#include <neo/io/stream/native.hpp>
+#include <neo/io/stream/string.hpp>
+
+#include <neo/platform.hpp>
+#include <neo/test_concept.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+NEO_TEST_CONCEPT(neo::layered<neo::instrumented_stream<neo::string_stream>>);
+NEO_TEST_CONCEPT(neo::read_write_stream<neo::instrumented_stream<neo::string_stream>>);
+
+TEST_CASE("Latency histogram buckets") {
+    using hist = neo::latency_histogram;
+    for (std::size_t idx = 0; idx < hist::bucket_count; ++idx) {
+        const auto low = hist::bucket_lower_bound(idx);
+        CHECK(hist::bucket_for(low) == idx);
+        if (idx > 0) {
+            CHECK(hist::bucket_for(low - 1) == idx - 1);
+        }
+    }
+    CHECK(hist::bucket_for(~std::uint64_t(0)) == hist::bucket_count - 1);
+    CHECK(hist::bucket_for(1000) == hist::bucket_for(1023));
+    CHECK(hist::bucket_for(1023) + 1 == hist::bucket_for(1024));
+
+    hist h;
+    CHECK(h.percentile(0.5).count() == 0);
+    for (auto i = 0; i < 90; ++i) {
+        h.record(std::chrono::nanoseconds(100));
+    }
+    for (auto i = 0; i < 10; ++i) {
+        h.record(std::chrono::microseconds(50));
+    }
+    CHECK(h.total_count() == 100);
+    auto bucket_of = [](std::uint64_t ns) {
+        return std::chrono::nanoseconds(hist::bucket_lower_bound(hist::bucket_for(ns)));
+    };
+    CHECK(h.percentile(0.5) == bucket_of(100));
+    CHECK(h.percentile(0.99) == bucket_of(50'000));
+}
+
+TEST_CASE("Count the transfers on a stream") {
+    neo::instrumented_stream strm{neo::string_stream{}};
+    auto&                    stats = strm.stats();
+
+    strm.write_some(neo::const_buffer("Hello!"));
+    CHECK(stats.write_calls == 1);
+    CHECK(stats.bytes_written == 6);
+    CHECK(strm.next_layer().string == "Hello!");
+
+    std::string buf;
+    buf.resize(4);
+    strm.read_some(neo::mutable_buffer(buf));
+    CHECK(stats.read_calls == 1);
+    CHECK(stats.bytes_read == 4);
+    CHECK(stats.short_reads == 0);
+
+    // Only two bytes remain
+    strm.read_some(neo::mutable_buffer(buf));
+    CHECK(stats.bytes_read == 6);
+    CHECK(stats.short_reads == 1);
+
+    strm.read_some(neo::mutable_buffer(buf));
+    CHECK(stats.eof_reads == 1);
+    CHECK(stats.read_calls == 3);
+    CHECK(stats.read_latency.total_count() == 3);
+    CHECK(stats.write_latency.total_count() == 1);
+
+    strm.reset_stats();
+    CHECK(stats.read_calls == 0);
+
+    strm.options().enabled = false;
+    strm.write_some(neo::const_buffer("Hello!"));
+    CHECK(stats.write_calls == 0);
+    CHECK(strm.next_layer().string == "Hello!");
+
+    strm.options() = {.time = false};
+    strm.write_some(neo::const_buffer("Hello!"));
+    CHECK(stats.write_calls == 1);
+    CHECK(stats.write_latency.total_count() == 0);
+}
+
+TEST_CASE("Aggregate the transfers of streams on several threads") {
+    neo::shared_io_stats       total;
+    std::vector<std::uint64_t> write_calls(4);
+    std::vector<std::thread>   threads;
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([&, i] {
+            neo::instrumented_stream strm{neo::string_stream{}, {.aggregate = &total}};
+            for (auto n = 0; n < 1000; ++n) {
+                strm.write_some(neo::const_buffer("data"));
+            }
+            write_calls[i] = strm.stats().write_calls;
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // Each stream only counts its own transfers
+    for (auto n : write_calls) {
+        CHECK(n == 1000);
+    }
+    auto snap = total.snapshot();
+    CHECK(snap.write_calls == 4000);
+    CHECK(snap.bytes_written == 16000);
+    CHECK(snap.write_latency.total_count() == 4000);
+    CHECK(snap.read_calls == 0);
+}
+
+#if NEO_OS_IS_UNIX_LIKE
+TEST_CASE("Count would-block reads") {
+    auto [in, out] = neo::testing::make_pipe();
+    in.set_nonblocking(true);
+
+    neo::instrumented_stream<neo::native_stream&> strm{in};
+
+    std::string buf;
+    buf.resize(4);
+    auto res = strm.read_some(neo::mutable_buffer(buf));
+    CHECK(res.would_block());
+    CHECK(strm.stats().would_block == 1);
+    CHECK(strm.stats().errors == 0);
+    CHECK(strm.stats().eof_reads == 0);
+}
+#endif
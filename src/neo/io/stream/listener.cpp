@@ -0,0 +1,194 @@
+#include "./listener.hpp"
+
+#include <neo/event.hpp>
+
+#if NEO_OS_IS_UNIX_LIKE
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int last_error_code() noexcept { return errno; }
+#elif NEO_OS_IS_WINDOWS
+#include <WS2tcpip.h>
+static int last_error_code() noexcept { return ::WSAGetLastError(); }
+#endif
+
+using namespace neo;
+
+namespace {
+
+#if NEO_OS_IS_WINDOWS
+using native_socket_handle = SOCKET;
+constexpr auto invalid_socket = INVALID_SOCKET;
+
+/// The connection was reset before we could accept it. Try the next one.
+bool should_retry_accept(int err) noexcept { return err == WSAECONNRESET; }
+/// There are no pending connections
+bool no_pending_connection(int err) noexcept { return err == WSAEWOULDBLOCK; }
+#else
+using native_socket_handle    = int;
+constexpr auto invalid_socket = -1;
+
+bool should_retry_accept(int err) noexcept { return err == ECONNABORTED || err == EINTR; }
+bool no_pending_connection(int err) noexcept { return err == EAGAIN || err == EWOULDBLOCK; }
+#endif
+
+/**
+ * Accept one connection from the listening socket. Where available, accept4()
+ * atomically sets close-on-exec and non-blocking mode on the new socket.
+ * Elsewhere, the new socket may inherit non-blocking mode from the listening
+ * socket, so the mode is set explicitly in both directions.
+ */
+native_socket_handle accept_one(native_socket_handle lfd, bool nonblocking) noexcept {
+#if defined(__linux__) || defined(__FreeBSD__)
+    return ::accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC | (nonblocking ? SOCK_NONBLOCK : 0));
+#elif NEO_OS_IS_UNIX_LIKE
+    auto fd = ::accept(lfd, nullptr, nullptr);
+    if (fd != -1) {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        auto flags = ::fcntl(fd, F_GETFL);
+        ::fcntl(fd, F_SETFL, nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+    }
+    return fd;
+#else
+    auto fd = ::accept(lfd, nullptr, nullptr);
+    if (fd != INVALID_SOCKET) {
+        u_long mode = nonblocking ? 1 : 0;
+        ::ioctlsocket(fd, FIONBIO, &mode);
+    }
+    return fd;
+#endif
+}
+
+/**
+ * Accept a pending connection without waiting, and without emitting
+ * listener::ev_accept. The caller emits the event.
+ */
+std::optional<neo::socket>
+try_accept_one(native_socket_handle lfd, bool nonblocking, std::error_code& ec) noexcept {
+    for (;;) {
+        auto fd = accept_one(lfd, nonblocking);
+        if (fd == invalid_socket) {
+            auto err = last_error_code();
+            if (should_retry_accept(err)) {
+                continue;
+            }
+            if (!no_pending_connection(err)) {
+                ec = std::error_code(err, std::system_category());
+            }
+            return std::nullopt;
+        }
+        neo::socket s;
+        s.native().reset(std::move(fd));
+        return s;
+    }
+}
+
+}  // namespace
+
+std::optional<listener>
+listener::open(address addr, options opts, std::error_code& ec) noexcept {
+    auto sock = socket::create(addr.get_family(), socket::type::stream, ec);
+    if (!sock) {
+        return std::nullopt;
+    }
+    auto fd = sock->native().native_handle();
+
+    auto set_opt = [&](int name) {
+        int one = 1;
+        if (::setsockopt(fd, SOL_SOCKET, name, reinterpret_cast<const char*>(&one), sizeof one)) {
+            ec = std::error_code(last_error_code(), std::system_category());
+        }
+    };
+    if (opts.reuse_address) {
+#if NEO_OS_IS_WINDOWS
+        // On Windows, SO_REUSEADDR would allow another socket to bind the same
+        // port, even while we are listening on it
+        set_opt(SO_EXCLUSIVEADDRUSE);
+#else
+        set_opt(SO_REUSEADDR);
+#endif
+    }
+    if (!ec && opts.reuse_port) {
+#ifdef SO_REUSEPORT
+        set_opt(SO_REUSEPORT);
+#else
+        ec = make_error_code(std::errc::operation_not_supported);
+#endif
+    }
+    if (ec) {
+        return std::nullopt;
+    }
+
+    sock->set_nonblocking(true, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    sock->bind(addr, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    sock->listen(opts.backlog, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    listener ret;
+    ret._sock = std::move(*sock);
+    ret._opts = opts;
+    return ret;
+}
+
+std::optional<neo::socket> listener::try_accept(std::error_code& ec) noexcept {
+    auto s = try_accept_one(_sock.native().native_handle(), _opts.nonblocking_accept, ec);
+    if (s) {
+        neo::emit(ev_accept{*this, 1});
+    }
+    return s;
+}
+
+std::optional<neo::socket> listener::accept(std::error_code& ec) noexcept {
+    for (;;) {
+        auto s = try_accept(ec);
+        if (s || ec) {
+            return s;
+        }
+        // Nothing is pending. Wait for a connection to arrive.
+#if NEO_OS_IS_UNIX_LIKE
+        ::pollfd pfd = {};
+        pfd.fd       = _sock.native().native_handle();
+        pfd.events   = POLLIN;
+        auto rc      = ::poll(&pfd, 1, -1);
+#elif NEO_OS_IS_WINDOWS
+        ::WSAPOLLFD pfd = {};
+        pfd.fd          = _sock.native().native_handle();
+        pfd.events      = POLLRDNORM;
+        auto rc         = ::WSAPoll(&pfd, 1, -1);
+#endif
+        if (rc < 0) {
+            auto err = last_error_code();
+            if (!should_retry_accept(err)) {
+                ec = std::error_code(err, std::system_category());
+                return std::nullopt;
+            }
+        }
+    }
+}
+
+std::size_t
+listener::accept_batch(std::vector<neo::socket>& out, std::size_t max, std::error_code& ec) {
+    std::size_t n_accepted = 0;
+    while (n_accepted < max) {
+        auto s = try_accept_one(_sock.native().native_handle(), _opts.nonblocking_accept, ec);
+        if (!s) {
+            break;
+        }
+        out.push_back(std::move(*s));
+        ++n_accepted;
+    }
+    if (n_accepted) {
+        neo::emit(ev_accept{*this, n_accepted});
+    }
+    return n_accepted;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <neo/io/stream/socket.hpp>
+
+#include <neo/error.hpp>
+
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace neo {
+
+/**
+ * @brief A listening stream socket that accepts incoming connections.
+ *
+ * The underlying socket is always in non-blocking mode, so that a backlog of
+ * pending connections can be drained in a single call to accept_batch(), and
+ * so that the listener may be registered with a `reactor`. accept() will wait
+ * for a connection to arrive.
+ */
+class listener {
+public:
+    /**
+     * @brief Options for opening a listener.
+     */
+    struct options {
+        /// The maximum length of the queue of pending connections
+        int backlog = 1024;
+        /**
+         * Set SO_REUSEADDR, allowing a restarted server to bind while old
+         * connections linger. On Windows, sets SO_EXCLUSIVEADDRUSE instead,
+         * since SO_REUSEADDR there allows other sockets to take over the port.
+         */
+        bool reuse_address = true;
+        /**
+         * Set SO_REUSEPORT, allowing several listeners to bind the same address.
+         * The kernel spreads incoming connections across the listeners, so each
+         * worker thread can own its own accept queue. (Not supported on Windows.)
+         */
+        bool reuse_port = false;
+        /// Place accepted sockets in non-blocking mode, ready for use with a `reactor`
+        bool nonblocking_accept = true;
+    };
+
+    /**
+     * @brief Emitted each time one or more connections are accepted.
+     *
+     * Subscribers can use this to track the accept rate of a listener.
+     */
+    struct ev_accept {
+        const listener& lis;
+        std::size_t     n_accepted;
+    };
+
+private:
+    socket  _sock;
+    options _opts;
+
+public:
+    listener() = default;
+
+    /**
+     * @brief Open a new listener bound to the given address. Throws on failure.
+     */
+    listener(address addr, options opts) {
+        error_code_thrower err;
+        auto               l = open(addr, opts, err);
+        err("Failed to open a listening socket");
+        *this = std::move(*l);
+    }
+
+    explicit listener(address addr)
+        : listener(addr, options{}) {}
+
+    /**
+     * @brief Open a new listener bound to the given address, or a nullopt in case of error.
+     */
+    static std::optional<listener> open(address addr, options opts, std::error_code& ec) noexcept;
+
+    /// Access the underlying native stream
+    auto& native() noexcept { return _sock.native(); }
+    auto& native() const noexcept { return _sock.native(); }
+
+    /**
+     * @brief The address that the listener is bound to. Useful when binding to
+     * port zero.
+     */
+    address local_address() const { return _sock.local_address(); }
+
+    /**
+     * @brief Accept a pending connection without waiting.
+     *
+     * @return The accepted socket, or a nullopt if no connection is pending or
+     *      an error occurred (in which case `ec` is set).
+     */
+    std::optional<socket> try_accept(std::error_code& ec) noexcept;
+
+    /**
+     * @brief Accept a connection, waiting for one to arrive if none are pending.
+     */
+    std::optional<socket> accept(std::error_code& ec) noexcept;
+    socket                accept() {
+        error_code_thrower err;
+        auto               s = accept(err);
+        err("Failed to accept an incoming connection");
+        return std::move(*s);
+    }
+
+    /**
+     * @brief Accept every connection that is pending on the listener, without
+     * waiting.
+     *
+     * @param out Accepted sockets are appended to this vector.
+     * @param max The maximum number of connections to accept.
+     * @return The number of connections that were accepted.
+     */
+    std::size_t accept_batch(std::vector<socket>& out, std::size_t max, std::error_code& ec);
+    std::size_t accept_batch(std::vector<socket>& out, std::size_t max = ~std::size_t(0)) {
+        return accept_batch(out, max, "Failed to accept incoming connections"_ec_throw);
+    }
+};
+
+}  // namespace neo
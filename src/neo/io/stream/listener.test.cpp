@@ -0,0 +1,88 @@
+#include <neo/io/stream/listener.hpp>
+
+#include <neo/io/read.hpp>
+#include <neo/io/write.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+TEST_CASE("Accept a connection") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto          addr = lis.local_address();
+    REQUIRE(addr.port() != 0);
+
+    auto client = neo::socket::open_connected(addr, neo::socket::type::stream);
+    auto server = lis.accept();
+
+    neo::write(client, neo::const_buffer("Hello, server"));
+    server.set_nonblocking(false);
+    std::string buf;
+    buf.resize(13);
+    auto res = neo::read(server, neo::mutable_buffer(buf));
+    CHECK_FALSE(res.error());
+    CHECK(buf == "Hello, server");
+
+    // Nothing else is pending
+    std::error_code ec;
+    CHECK_FALSE(lis.try_accept(ec));
+    CHECK_FALSE(ec);
+}
+
+TEST_CASE("Accept a batch of connections") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto          addr = lis.local_address();
+
+    std::vector<neo::socket> clients;
+    for (auto i = 0; i < 5; ++i) {
+        clients.push_back(neo::socket::open_connected(addr, neo::socket::type::stream));
+    }
+
+    std::vector<neo::socket> accepted;
+    // Connections may still be in-flight through the loopback. Keep draining.
+    for (auto i = 0; i < 100 && accepted.size() < clients.size(); ++i) {
+        lis.accept_batch(accepted);
+    }
+    CHECK(accepted.size() == clients.size());
+
+    // Accepted sockets are non-blocking by default
+    std::string buf;
+    buf.resize(8);
+    auto res = accepted.front().read_some(neo::mutable_buffer(buf));
+    CHECK(res.would_block());
+}
+
+TEST_CASE("Accept a blocking connection") {
+    neo::listener::options opts;
+    opts.nonblocking_accept = false;
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0"), opts};
+
+    auto client = neo::socket::open_connected(lis.local_address(), neo::socket::type::stream);
+    auto server = lis.accept();
+
+    // Nothing has been sent yet, so the read must wait for the writer
+    std::thread writer{[&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        neo::write(client, neo::const_buffer("ping"));
+    }};
+    std::string buf;
+    buf.resize(4);
+    auto res = server.read_some(neo::mutable_buffer(buf));
+    writer.join();
+    CHECK_FALSE(res.would_block());
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred != 0);
+}
+
+#if __linux__ || __APPLE__ || __FreeBSD__
+TEST_CASE("Share a port between listeners") {
+    neo::listener::options opts;
+    opts.reuse_port = true;
+    neo::listener first{neo::address::resolve("127.0.0.1", "0"), opts};
+    auto          port = std::to_string(first.local_address().port());
+    neo::listener second{neo::address::resolve("127.0.0.1", port), opts};
+    CHECK(second.local_address().port() == first.local_address().port());
+}
+#endif
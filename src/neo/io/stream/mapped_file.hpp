@@ -0,0 +1,256 @@
+#pragma once
+
+#include <neo/io/concepts/result.hpp>
+#include <neo/io/stream/file.hpp>
+
+#include <neo/buffer_algorithm.hpp>
+#include <neo/const_buffer.hpp>
+#include <neo/error.hpp>
+#include <neo/platform.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+
+namespace neo {
+
+/**
+ * @brief Hints to the system about how a mapped file will be accessed.
+ */
+enum class map_advice {
+    /// No special treatment
+    normal,
+    /// Pages will be accessed in order. Read ahead aggressively, and drop pages after use.
+    sequential,
+    /// Pages will be accessed in random order. Do not read ahead.
+    random,
+    /// The pages will be needed soon. Begin reading them in now.
+    will_need,
+    /// The pages will not be needed soon. The system may drop them.
+    dont_need,
+    /// Back the mapping with huge pages, if the system and filesystem support it.
+    huge_pages,
+};
+
+/**
+ * @brief A read-only memory mapping of a file.
+ *
+ * The mapping covers a window of the file, which may be the entire file, or
+ * only part of it. The window may be moved with remap(), allowing files that
+ * are too large to map at once to be scanned a piece at a time. The offset of
+ * the window need not be page-aligned.
+ *
+ * The file must not be truncated while it is mapped.
+ */
+class mapped_file {
+    file_stream _file;
+#if NEO_OS_IS_WINDOWS
+    /// The file mapping object from which views are mapped
+    native_stream _mapping;
+#endif
+    /// The size of the file at the time it was opened
+    std::uint64_t _file_size = 0;
+    /// The offset of the window within the file
+    std::uint64_t _offset = 0;
+    /// The base of the mapping, which is aligned to a page boundary
+    std::byte* _map_base = nullptr;
+    /// The total length of the mapping
+    std::size_t _map_len = 0;
+    /// The offset of the window within the mapping
+    std::size_t _slack = 0;
+    /// The size of the window
+    std::size_t _size = 0;
+    /// The most recent advice, which is applied again whenever the file is remapped
+    map_advice _advice = map_advice::normal;
+
+    void _unmap() noexcept;
+    void _apply_advice(map_advice, std::error_code& ec) noexcept;
+
+public:
+    /// Map the remainder of the file, starting at the window offset
+    constexpr static std::size_t whole_file = ~std::size_t(0);
+
+    /// Default-construct an empty mapping
+    mapped_file() = default;
+    ~mapped_file() { _unmap(); }
+
+    mapped_file(mapped_file&& o) noexcept { *this = std::move(o); }
+    mapped_file& operator=(mapped_file&& o) noexcept;
+
+    /**
+     * @brief Map the file at the given path.
+     *
+     * @param fpath The path to an existing file.
+     * @param offset The offset of the mapping window within the file.
+     * @param window The size of the mapping window. The window is truncated at
+     *      the end of the file.
+     */
+    explicit mapped_file(const std::filesystem::path& fpath,
+                         std::uint64_t                offset = 0,
+                         std::size_t                  window = whole_file) {
+        error_code_thrower err;
+        auto               mf = open(fpath, offset, window, err);
+        err("Failed to map file [{}]", fpath.string());
+        *this = std::move(*mf);
+    }
+
+    /**
+     * @brief Map the file at the given path, or return a nullopt in case of error.
+     */
+    static std::optional<mapped_file> open(const std::filesystem::path& fpath,
+                                           std::uint64_t                offset,
+                                           std::size_t                  window,
+                                           std::error_code&             ec) noexcept;
+
+    static std::optional<mapped_file> open(const std::filesystem::path& fpath,
+                                           std::error_code&             ec) noexcept {
+        return open(fpath, 0, whole_file, ec);
+    }
+
+    /**
+     * @brief The contents of the mapping window.
+     */
+    const_buffer data() const noexcept { return const_buffer(_map_base + _slack, _size); }
+
+    /// The size of the file
+    std::uint64_t file_size() const noexcept { return _file_size; }
+    /// The offset of the mapping window within the file
+    std::uint64_t offset() const noexcept { return _offset; }
+
+    /**
+     * @brief Move the mapping window.
+     *
+     * Invalidates buffers that were previously obtained from data(). If the
+     * remap fails, the mapping will be empty.
+     *
+     * @param offset The new offset of the mapping window within the file.
+     * @param window The size of the new mapping window.
+     */
+    void remap(std::uint64_t offset, std::size_t window, std::error_code& ec) noexcept;
+    void remap(std::uint64_t offset, std::size_t window = whole_file) {
+        remap(offset, window, "Failed to remap a file"_ec_throw);
+    }
+
+    /**
+     * @brief Advise the system of how the mapping will be accessed.
+     *
+     * The advice is remembered, and is applied again when the window is moved.
+     * `huge_pages` fails with an error if the system does not support huge
+     * pages for file mappings.
+     */
+    void advise(map_advice advice, std::error_code& ec) noexcept;
+    void advise(map_advice advice) {
+        advise(advice, "Failed to apply advice to a mapped file"_ec_throw);
+    }
+};
+
+/**
+ * @brief A read_stream and buffer_source over a memory-mapped file.
+ *
+ * Data is read from the mapping directly, without copying it into a separate
+ * buffer. When used as a buffer_source (with next() and consume()), the
+ * returned buffers refer to the mapping itself. Only `window_size` bytes of the
+ * file are mapped at a time, and the window slides forward as data is
+ * consumed.
+ */
+class mmap_stream {
+    mapped_file _file;
+    std::size_t _window_size = default_window_size;
+    /// The read position within the current window
+    std::size_t _pos = 0;
+
+    const_buffer _remaining() const noexcept {
+        auto buf = _file.data();
+        buf += _pos;
+        return buf;
+    }
+
+    bool         _at_end_of_file() const noexcept {
+        return _file.offset() + _file.data().size() >= _file.file_size();
+    }
+
+    /**
+     * Ensure that at least `n` bytes (or all that remain in the file) are
+     * available contiguously in the current window.
+     */
+    void _ensure_available(std::size_t n, std::error_code& ec) noexcept {
+        if (_remaining().size() < n && !_at_end_of_file()) {
+            _file.remap(_file.offset() + _pos, _window_size, ec);
+            _pos = 0;
+        }
+    }
+
+public:
+    /// The default size of the mapping window: 64 MiB
+    constexpr static std::size_t default_window_size = 1024 * 1024 * 64;
+
+    mmap_stream() = default;
+
+    /**
+     * @brief Open a stream of the file at the given path.
+     *
+     * @param fpath The path to an existing file.
+     * @param window_size The amount of the file to map at once.
+     * @param advice Advice to apply to the mapping. The default expects a
+     *      front-to-back scan.
+     */
+    explicit mmap_stream(const std::filesystem::path& fpath,
+                         std::size_t                  window_size = default_window_size,
+                         map_advice                   advice      = map_advice::sequential)
+        : _file(fpath, 0, window_size)
+        , _window_size(window_size) {
+        // Advice is only a hint. Ignore failures.
+        std::error_code ec;
+        _file.advise(advice, ec);
+    }
+
+    /// Access the underlying mapping
+    auto& mapping() noexcept { return _file; }
+    auto& mapping() const noexcept { return _file; }
+
+    /// The number of bytes that have not yet been consumed
+    std::uint64_t remaining() const noexcept {
+        return _file.file_size() - _file.offset() - _pos;
+    }
+
+    /**
+     * @brief Obtain up to `n` bytes of the file, without copying.
+     *
+     * If fewer than `n` bytes remain in the current window, the window is moved
+     * forward. The returned buffer is limited to the window size, and is valid
+     * until the next call to next() or read_some().
+     */
+    const_buffer next(std::size_t n) {
+        _ensure_available(n, "Failed to remap the window of an mmap_stream"_ec_throw);
+        return _remaining().first(n);
+    }
+
+    /**
+     * @brief Discard `n` bytes from the beginning of the stream.
+     */
+    void consume(std::size_t n) noexcept {
+        neo_assert(expects,
+                   n <= _remaining().size(),
+                   "Consumed more bytes than were returned by next()",
+                   n,
+                   _remaining().size());
+        _pos += n;
+    }
+
+    /**
+     * @brief Copy data from the file into the given buffers.
+     */
+    template <mutable_buffer_range Bufs>
+    basic_transfer_result read_some(const Bufs& bufs) noexcept {
+        // Only move the window once it is exhausted. There is no need for the
+        // data to be contiguous, and this avoids needless remapping.
+        std::error_code ec;
+        _ensure_available(1, ec);
+        auto n_copied = buffer_copy(bufs, _remaining());
+        _pos += n_copied;
+        return {n_copied, ec};
+    }
+};
+
+}  // namespace neo
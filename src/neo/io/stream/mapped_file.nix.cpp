@@ -0,0 +1,142 @@
+#include <neo/io/stream/mapped_file.hpp>
+
+#if !_WIN32
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace neo;
+
+namespace {
+
+std::error_code last_error() noexcept { return std::error_code(errno, std::system_category()); }
+
+std::uint64_t page_size() noexcept {
+    static const auto size = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+}  // namespace
+
+mapped_file& mapped_file::operator=(mapped_file&& o) noexcept {
+    _unmap();
+    _file      = std::move(o._file);
+    _file_size = std::exchange(o._file_size, 0);
+    _offset    = std::exchange(o._offset, 0);
+    _map_base  = std::exchange(o._map_base, nullptr);
+    _map_len   = std::exchange(o._map_len, 0);
+    _slack     = std::exchange(o._slack, 0);
+    _size      = std::exchange(o._size, 0);
+    _advice    = std::exchange(o._advice, map_advice::normal);
+    return *this;
+}
+
+std::optional<mapped_file> mapped_file::open(const std::filesystem::path& fpath,
+                                             std::uint64_t                offset,
+                                             std::size_t                  window,
+                                             std::error_code&             ec) noexcept {
+    auto file = file_stream::open(fpath, open_mode::read, ec);
+    if (!file) {
+        return std::nullopt;
+    }
+    struct ::stat st;
+    if (::fstat(file->native().native_handle(), &st) == -1) {
+        ec = last_error();
+        return std::nullopt;
+    }
+    mapped_file ret;
+    ret._file      = std::move(*file);
+    ret._file_size = static_cast<std::uint64_t>(st.st_size);
+    ret.remap(offset, window, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return ret;
+}
+
+void mapped_file::_unmap() noexcept {
+    if (_map_base) {
+        ::munmap(_map_base, _map_len);
+    }
+    _map_base = nullptr;
+    _map_len  = 0;
+    _slack    = 0;
+    _size     = 0;
+}
+
+void mapped_file::remap(std::uint64_t offset, std::size_t window, std::error_code& ec) noexcept {
+    _unmap();
+    if (offset > _file_size) {
+        ec = make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    _offset  = offset;
+    auto len = static_cast<std::size_t>((std::min)(std::uint64_t(window), _file_size - offset));
+    if (len == 0) {
+        // mmap() refuses to create an empty mapping
+        return;
+    }
+    // The offset of the mapping must be page-aligned. Map the slack before the window, too.
+    auto slack = static_cast<std::size_t>(offset % page_size());
+    auto ptr   = ::mmap(nullptr,
+                      len + slack,
+                      PROT_READ,
+                      MAP_SHARED,
+                      _file.native().native_handle(),
+                      static_cast<::off_t>(offset - slack));
+    if (ptr == MAP_FAILED) {
+        ec = last_error();
+        return;
+    }
+    _map_base = static_cast<std::byte*>(ptr);
+    _map_len  = len + slack;
+    _slack    = slack;
+    _size     = len;
+    if (_advice != map_advice::normal) {
+        // The advice was accepted before, so a failure here is not worth reporting
+        std::error_code ignore;
+        _apply_advice(_advice, ignore);
+    }
+}
+
+void mapped_file::_apply_advice(map_advice advice, std::error_code& ec) noexcept {
+    int adv = MADV_NORMAL;
+    switch (advice) {
+    case map_advice::normal:
+        adv = MADV_NORMAL;
+        break;
+    case map_advice::sequential:
+        adv = MADV_SEQUENTIAL;
+        break;
+    case map_advice::random:
+        adv = MADV_RANDOM;
+        break;
+    case map_advice::will_need:
+        adv = MADV_WILLNEED;
+        break;
+    case map_advice::dont_need:
+        adv = MADV_DONTNEED;
+        break;
+    case map_advice::huge_pages:
+#ifdef MADV_HUGEPAGE
+        adv = MADV_HUGEPAGE;
+        break;
+#else
+        ec = make_error_code(std::errc::operation_not_supported);
+        return;
+#endif
+    }
+    if (_map_base && ::madvise(_map_base, _map_len, adv) == -1) {
+        ec = last_error();
+    }
+}
+
+void mapped_file::advise(map_advice advice, std::error_code& ec) noexcept {
+    _apply_advice(advice, ec);
+    if (!ec) {
+        _advice = advice;
+    }
+}
+
+#endif  // !_WIN32
@@ -0,0 +1,99 @@
+#include <neo/io/stream/mapped_file.hpp>
+
+#include <neo/io/concepts/stream.hpp>
+#include <neo/io/read.hpp>
+#include <neo/io/write.hpp>
+
+#include <neo/buffer_source.hpp>
+#include <neo/test_concept.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <string_view>
+
+NEO_TEST_CONCEPT(neo::read_stream<neo::mmap_stream>);
+NEO_TEST_CONCEPT(neo::buffer_source<neo::mmap_stream>);
+
+namespace {
+
+std::string_view as_view(neo::const_buffer buf) {
+    return std::string_view(reinterpret_cast<const char*>(buf.data()), buf.size());
+}
+
+std::string write_test_file(const std::string& path) {
+    std::string content;
+    for (auto i = 0; content.size() < 100'000; ++i) {
+        content += std::to_string(i) + ";";
+    }
+    neo::file_stream file(path, neo::open_mode::write);
+    REQUIRE_FALSE(neo::write(file, neo::const_buffer(content)).error());
+    return content;
+}
+
+}  // namespace
+
+TEST_CASE("Map a file") {
+    auto content = write_test_file("mapped-test.txt");
+
+    neo::mapped_file mf{"mapped-test.txt"};
+    CHECK(mf.file_size() == content.size());
+    CHECK(as_view(mf.data()) == content);
+    mf.advise(neo::map_advice::sequential);
+    mf.advise(neo::map_advice::will_need);
+
+    // Map a window at an offset that is not page-aligned
+    mf.remap(5000, 300);
+    CHECK(mf.offset() == 5000);
+    CHECK(as_view(mf.data()) == content.substr(5000, 300));
+
+    // The window is truncated at the end of the file
+    mf.remap(content.size() - 10, 300);
+    CHECK(as_view(mf.data()) == content.substr(content.size() - 10));
+
+    mf.remap(content.size());
+    CHECK(mf.data().size() == 0);
+
+    std::error_code ec;
+    mf.remap(content.size() + 1, 1, ec);
+    CHECK(ec == std::errc::invalid_argument);
+}
+
+TEST_CASE("Map an empty file") {
+    neo::file_stream("mapped-empty.txt", neo::open_mode::write).close();
+    neo::mapped_file mf{"mapped-empty.txt"};
+    CHECK(mf.data().size() == 0);
+}
+
+TEST_CASE("Read from an mmap_stream") {
+    auto content = write_test_file("mapped-test.txt");
+
+    // Use a small window to force sliding it through the file
+    neo::mmap_stream strm{"mapped-test.txt", 4096 + 7};
+    std::string      got;
+    got.resize(content.size() + 10);
+    auto res = neo::read(strm, neo::mutable_buffer(got));
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == content.size());
+    got.resize(res.bytes_transferred);
+    CHECK(got == content);
+    CHECK(strm.remaining() == 0);
+}
+
+TEST_CASE("Consume an mmap_stream as a buffer_source") {
+    auto content = write_test_file("mapped-test.txt");
+
+    neo::mmap_stream strm{"mapped-test.txt", 4096 + 7};
+    std::string      got;
+    while (true) {
+        auto part = strm.next(1000);
+        if (part.size() == 0) {
+            break;
+        }
+        // Requests are satisfied with contiguous data, even across windows
+        CHECK((part.size() == 1000 || strm.remaining() == part.size()));
+        got.append(as_view(part));
+        strm.consume(part.size());
+    }
+    CHECK(got == content);
+}
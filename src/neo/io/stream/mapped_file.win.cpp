@@ -0,0 +1,153 @@
+#include <neo/io/stream/mapped_file.hpp>
+
+#if _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+using namespace neo;
+
+namespace {
+
+std::error_code last_error() noexcept {
+    return std::error_code(::GetLastError(), std::system_category());
+}
+
+/// Views of a file mapping must begin on a multiple of the allocation granularity
+std::uint64_t allocation_granularity() noexcept {
+    static const auto size = [] {
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return static_cast<std::uint64_t>(info.dwAllocationGranularity);
+    }();
+    return size;
+}
+
+}  // namespace
+
+mapped_file& mapped_file::operator=(mapped_file&& o) noexcept {
+    _unmap();
+    _file      = std::move(o._file);
+    _mapping   = std::move(o._mapping);
+    _file_size = std::exchange(o._file_size, 0);
+    _offset    = std::exchange(o._offset, 0);
+    _map_base  = std::exchange(o._map_base, nullptr);
+    _map_len   = std::exchange(o._map_len, 0);
+    _slack     = std::exchange(o._slack, 0);
+    _size      = std::exchange(o._size, 0);
+    _advice    = std::exchange(o._advice, map_advice::normal);
+    return *this;
+}
+
+std::optional<mapped_file> mapped_file::open(const std::filesystem::path& fpath,
+                                             std::uint64_t                offset,
+                                             std::size_t                  window,
+                                             std::error_code&             ec) noexcept {
+    auto file = file_stream::open(fpath, open_mode::read, ec);
+    if (!file) {
+        return std::nullopt;
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file->native().native_handle(), &size)) {
+        ec = last_error();
+        return std::nullopt;
+    }
+    mapped_file ret;
+    ret._file_size = static_cast<std::uint64_t>(size.QuadPart);
+    if (ret._file_size != 0) {
+        // Windows refuses to create a mapping object for an empty file
+        auto hndl = ::CreateFileMappingW(file->native().native_handle(),
+                                         nullptr,
+                                         PAGE_READONLY,
+                                         0,
+                                         0,
+                                         nullptr);
+        if (hndl == nullptr) {
+            ec = last_error();
+            return std::nullopt;
+        }
+        ret._mapping = native_stream::from_native_handle(std::move(hndl));
+    }
+    ret._file = std::move(*file);
+    ret.remap(offset, window, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return ret;
+}
+
+void mapped_file::_unmap() noexcept {
+    if (_map_base) {
+        ::UnmapViewOfFile(_map_base);
+    }
+    _map_base = nullptr;
+    _map_len  = 0;
+    _slack    = 0;
+    _size     = 0;
+}
+
+void mapped_file::remap(std::uint64_t offset, std::size_t window, std::error_code& ec) noexcept {
+    _unmap();
+    if (offset > _file_size) {
+        ec = make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    _offset  = offset;
+    auto len = static_cast<std::size_t>((std::min)(std::uint64_t(window), _file_size - offset));
+    if (len == 0) {
+        return;
+    }
+    auto slack       = static_cast<std::size_t>(offset % allocation_granularity());
+    auto view_offset = offset - slack;
+    auto ptr         = ::MapViewOfFile(_mapping.native_handle(),
+                               FILE_MAP_READ,
+                               static_cast<DWORD>(view_offset >> 32),
+                               static_cast<DWORD>(view_offset & 0xffff'ffff),
+                               len + slack);
+    if (ptr == nullptr) {
+        ec = last_error();
+        return;
+    }
+    _map_base = static_cast<std::byte*>(ptr);
+    _map_len  = len + slack;
+    _slack    = slack;
+    _size     = len;
+    if (_advice != map_advice::normal) {
+        std::error_code ignore;
+        _apply_advice(_advice, ignore);
+    }
+}
+
+void mapped_file::_apply_advice(map_advice advice, std::error_code& ec) noexcept {
+    switch (advice) {
+    case map_advice::will_need:
+        if (_map_base) {
+            WIN32_MEMORY_RANGE_ENTRY range;
+            range.VirtualAddress = _map_base;
+            range.NumberOfBytes  = _map_len;
+            if (!::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0)) {
+                ec = last_error();
+            }
+        }
+        return;
+    case map_advice::huge_pages:
+        // Large pages cannot be used for views of files
+        ec = make_error_code(std::errc::operation_not_supported);
+        return;
+    case map_advice::normal:
+    case map_advice::sequential:
+    case map_advice::random:
+    case map_advice::dont_need:
+        // There is no equivalent for these on Windows. They are only hints.
+        return;
+    }
+}
+
+void mapped_file::advise(map_advice advice, std::error_code& ec) noexcept {
+    _apply_advice(advice, ec);
+    if (!ec) {
+        _advice = advice;
+    }
+}
+
+#endif  // _WIN32
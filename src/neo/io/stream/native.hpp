@@ -8,6 +8,8 @@
 
 #include <neo/io/concepts/stream.hpp>
 
+#include <neo/error.hpp>
+
 namespace neo {
 
 class native_stream : native_stream_base {
@@ -17,7 +19,10 @@ public:
 
     using native_stream_base::close;
     using native_stream_base::read_some;
+    using native_stream_base::read_some_at;
+    using native_stream_base::set_nonblocking;
     using native_stream_base::write_some;
+    using native_stream_base::write_some_at;
 
 public:
     /**
@@ -62,6 +67,16 @@ public:
         this->_native_handle = std::exchange(hndl, this->invalid_native_handle_value);
     }
 
+    /**
+     * Place the stream in non-blocking mode (or return it to blocking mode). In
+     * non-blocking mode, read_some() and write_some() will return a result for
+     * which `would_block()` is `true` instead of waiting for the stream to
+     * become ready.
+     */
+    void set_nonblocking(bool nonblocking) {
+        set_nonblocking(nonblocking, "Failed to change the blocking mode of a stream"_ec_throw);
+    }
+
     /**
      * Adopt ownership over the given handle object. The handle must be given as
      * an rvalue-reference, which will be set to the invalid handle value.
@@ -75,6 +90,20 @@ public:
 
 using native_stream_handle = native_stream::native_handle_type;
 
+/**
+ * Obtain the native handle of a stream. Accepts native streams as well as
+ * objects that expose their native stream via a `.native()` accessor (such as
+ * file_stream and socket).
+ */
+template <typename Stream>
+constexpr auto native_handle_of(const Stream& strm) noexcept {
+    if constexpr (requires { strm.native_handle(); }) {
+        return strm.native_handle();
+    } else {
+        return strm.native().native_handle();
+    }
+}
+
 using native_read_result  = read_result_t<native_stream>;
 using native_write_result = write_result_t<native_stream>;
 
@@ -4,12 +4,17 @@
 
 #include <neo/io/stream/stdio.hpp>
 
+#include <fcntl.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <climits>
 #include <cstdio>
 #include <iostream>
+#include <memory>
+#include <new>
 
 using namespace neo;
 
@@ -24,17 +29,38 @@ static_assert(sizeof(posix_iovec_type) == sizeof(iovec)
               "expectation. This means that we haven't considered the iovec for your platform. "
               "Please file a bug report!");
 
-/// The number of iovec elements is defined by IOV_MAX, but we don't want to make a ridiculously
-/// large static array in case it is too large. Cap the length to 16 elements.
-constexpr int tl_iov_arr_len = (std::min)(IOV_MAX, 16);
+/// The initial length of each thread's iovec array. Most buffer sequences are short, so we start
+/// with a small inline array and only allocate when a longer sequence comes along.
+constexpr std::size_t tl_iov_initial_len = (std::min)(IOV_MAX, 16);
 
-std::array<posix_iovec_type, tl_iov_arr_len> tl_small_iov_array;
+/// The maximum length of each thread's iovec array.
+constexpr std::size_t tl_iov_max_len = IOV_MAX;
+
+thread_local std::array<posix_iovec_type, tl_iov_initial_len> tl_inline_iov_array;
+/// Storage for the iovec array once it has outgrown the inline array
+thread_local std::unique_ptr<posix_iovec_type[]> tl_heap_iov_array;
 
 }  // namespace
 
 /// Initialize the class-thread_local pointer to the iovec array
-thread_local posix_iovec_type* posix_fd_stream_base::_tl_small_iov_array
-    = tl_small_iov_array.data();
+thread_local std::size_t       posix_fd_stream_base::_tl_iov_arr_len = tl_iov_initial_len;
+thread_local posix_iovec_type* posix_fd_stream_base::_tl_iov_array   = tl_inline_iov_array.data();
+
+bool posix_fd_stream_base::_grow_tl_iov_array() noexcept {
+    if (_tl_iov_arr_len >= tl_iov_max_len) {
+        return false;
+    }
+    auto new_len = (std::min)(_tl_iov_arr_len * 2, tl_iov_max_len);
+    std::unique_ptr<posix_iovec_type[]> new_arr{new (std::nothrow) posix_iovec_type[new_len]};
+    if (!new_arr) {
+        return false;
+    }
+    std::copy_n(_tl_iov_array, _tl_iov_arr_len, new_arr.get());
+    tl_heap_iov_array = std::move(new_arr);
+    _tl_iov_array     = tl_heap_iov_array.get();
+    _tl_iov_arr_len   = new_len;
+    return true;
+}
 
 void posix_fd_stream_base::close() noexcept {
     if (_native_handle != invalid_native_handle_value) {
@@ -46,12 +72,30 @@ void posix_fd_stream_base::close() noexcept {
     }
 }
 
+void posix_fd_stream_base::set_nonblocking(bool nonblocking, std::error_code& ec) noexcept {
+    auto flags = ::fcntl(_native_handle, F_GETFL);
+    if (flags == -1) {
+        ec = std::error_code(errno, std::system_category());
+        return;
+    }
+    auto new_flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if (new_flags != flags && ::fcntl(_native_handle, F_SETFL, new_flags) == -1) {
+        ec = std::error_code(errno, std::system_category());
+    }
+}
+
 native_stream_write_result posix_fd_stream_base::_do_writev(std::size_t n_bufs) noexcept {
-    auto iov_ptr  = reinterpret_cast<const iovec*>(_tl_small_iov_array);
+    auto iov_ptr  = reinterpret_cast<const iovec*>(_tl_iov_array);
     auto nwritten = ::writev(_native_handle, iov_ptr, static_cast<int>(n_bufs));
     return _mk_result<native_stream_write_result>(nwritten);
 }
 
+native_stream_read_result posix_fd_stream_base::_do_readv(std::size_t n_bufs) noexcept {
+    auto iov_ptr = reinterpret_cast<const iovec*>(_tl_iov_array);
+    auto nread   = ::readv(_native_handle, iov_ptr, static_cast<int>(n_bufs));
+    return _mk_result<native_stream_read_result>(nread);
+}
+
 native_stream_write_result posix_fd_stream_base::_do_write_some(const_buffer buf) noexcept {
     auto nwritten = ::write(_native_handle, buf.data(), buf.size());
     return _mk_result<native_stream_write_result>(nwritten);
@@ -64,6 +108,95 @@ native_stream_read_result posix_fd_stream_base::_do_read_some(mutable_buffer buf
 
 namespace {
 
+/**
+ * Convert rw_flags to the flags of preadv2()/pwritev2(). Returns false if a
+ * flag is not supported on this system.
+ */
+bool to_rwf_flags(rw_flags flags, int& out) noexcept {
+    out         = 0;
+    auto is_set = test_flags(flags);
+#if defined(RWF_NOWAIT)
+    if (is_set(rw_flags::nowait)) {
+        out |= RWF_NOWAIT;
+    }
+    if (is_set(rw_flags::dsync)) {
+        out |= RWF_DSYNC;
+    }
+    if (is_set(rw_flags::sync)) {
+        out |= RWF_SYNC;
+    }
+    if (is_set(rw_flags::high_priority)) {
+        out |= RWF_HIPRI;
+    }
+    return true;
+#else
+    return flags == rw_flags::none;
+#endif
+}
+
+}  // namespace
+
+native_stream_write_result posix_fd_stream_base::_do_pwritev(std::uint64_t offset,
+                                                             std::size_t   n_bufs,
+                                                             rw_flags      flags) noexcept {
+    auto iov_ptr = reinterpret_cast<const iovec*>(_tl_iov_array);
+    auto off     = static_cast<::off_t>(offset);
+    int  rwf     = 0;
+    if (!to_rwf_flags(flags, rwf)) {
+        return {{0, EOPNOTSUPP}};
+    }
+#if defined(RWF_NOWAIT)
+    auto nwritten = rwf ? ::pwritev2(_native_handle, iov_ptr, static_cast<int>(n_bufs), off, rwf)
+                        : ::pwritev(_native_handle, iov_ptr, static_cast<int>(n_bufs), off);
+#else
+    auto nwritten = ::pwritev(_native_handle, iov_ptr, static_cast<int>(n_bufs), off);
+#endif
+    return _mk_result<native_stream_write_result>(nwritten);
+}
+
+native_stream_read_result posix_fd_stream_base::_do_preadv(std::uint64_t offset,
+                                                           std::size_t   n_bufs,
+                                                           rw_flags      flags) noexcept {
+    auto iov_ptr = reinterpret_cast<const iovec*>(_tl_iov_array);
+    auto off     = static_cast<::off_t>(offset);
+    int  rwf     = 0;
+    if (!to_rwf_flags(flags, rwf)) {
+        return {{0, EOPNOTSUPP}};
+    }
+#if defined(RWF_NOWAIT)
+    auto nread = rwf ? ::preadv2(_native_handle, iov_ptr, static_cast<int>(n_bufs), off, rwf)
+                     : ::preadv(_native_handle, iov_ptr, static_cast<int>(n_bufs), off);
+#else
+    auto nread = ::preadv(_native_handle, iov_ptr, static_cast<int>(n_bufs), off);
+#endif
+    return _mk_result<native_stream_read_result>(nread);
+}
+
+native_stream_write_result posix_fd_stream_base::_do_write_some_at(std::uint64_t offset,
+                                                                   const_buffer  buf,
+                                                                   rw_flags      flags) noexcept {
+    if (flags != rw_flags::none) {
+        // Only the vectored variant accepts flags
+        _tl_iov_array[0] = {const_cast<std::byte*>(buf.data()), buf.size()};
+        return _do_pwritev(offset, 1, flags);
+    }
+    auto nwritten = ::pwrite(_native_handle, buf.data(), buf.size(), static_cast<::off_t>(offset));
+    return _mk_result<native_stream_write_result>(nwritten);
+}
+
+native_stream_read_result posix_fd_stream_base::_do_read_some_at(std::uint64_t  offset,
+                                                                 mutable_buffer buf,
+                                                                 rw_flags       flags) noexcept {
+    if (flags != rw_flags::none) {
+        _tl_iov_array[0] = {buf.data(), buf.size()};
+        return _do_preadv(offset, 1, flags);
+    }
+    auto nread = ::pread(_native_handle, buf.data(), buf.size(), static_cast<::off_t>(offset));
+    return _mk_result<native_stream_read_result>(nread);
+}
+
+namespace {
+
 struct nonown_fd_stream : neo::native_stream {
     ~nonown_fd_stream() { (void)this->release(); }
     nonown_fd_stream(native_handle_type fd) { reset(std::move(fd)); }
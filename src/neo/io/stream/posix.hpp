@@ -1,10 +1,14 @@
 #pragma once
 
 #include <neo/io/stream/result.hpp>
+#include <neo/io/stream/rw_flags.hpp>
 
 #include <neo/assert.hpp>
 #include <neo/buffer_range.hpp>
 
+#include <cstdint>
+#include <system_error>
+
 namespace neo {
 
 struct posix_iovec_type {
@@ -50,18 +54,51 @@ protected:
         return _do_write_some(in);
     }
 
+    /**
+     * Read from the stream at the given offset, without using or modifying the
+     * file position.
+     */
+    template <mutable_buffer_range Bufs>
+    [[nodiscard]] native_stream_read_result
+    read_some_at(std::uint64_t offset, Bufs out, rw_flags flags = rw_flags::none) noexcept {
+        return _do_read_some_at(offset, out, flags);
+    }
+
+    /**
+     * Write to the stream at the given offset, without using or modifying the
+     * file position.
+     */
+    template <buffer_range Bufs>
+    [[nodiscard]] native_stream_write_result
+    write_some_at(std::uint64_t offset, Bufs in, rw_flags flags = rw_flags::none) noexcept {
+        return _do_write_some_at(offset, in, flags);
+    }
+
     /**
      * Close the stream
      */
     void close() noexcept;
 
+    /**
+     * Enable or disable non-blocking mode (O_NONBLOCK) on the file descriptor.
+     */
+    void set_nonblocking(bool, std::error_code& ec) noexcept;
+
 private:
-    // For decent performance in the case of a lot of small buffers, we have a thread-local array of
-    // iovec objects that can are set to refer to the buffers in a given buffer sequence, and then
-    // vectored IO is executed against that array. The array is stored in a separate TU, so we just
-    // declare a pointer here.
+    // For decent performance in the case of a lot of small buffers, each thread has an array of
+    // iovec objects that are set to refer to the buffers in a given buffer sequence, and then
+    // vectored IO is executed against that array. The array starts small and is grown on demand
+    // (up to IOV_MAX elements) so that a large buffer sequence can be written with a single
+    // syscall. The storage lives in a separate TU, so we just declare a pointer here.
     static thread_local std::size_t       _tl_iov_arr_len;
-    static thread_local posix_iovec_type* _tl_small_iov_array;
+    static thread_local posix_iovec_type* _tl_iov_array;
+
+    /**
+     * Grow the calling thread's iovec array, preserving its contents.
+     * @returns false if the array is already IOV_MAX elements long, or if
+     * allocation fails.
+     */
+    static bool _grow_tl_iov_array() noexcept;
 
     native_stream_write_result _do_writev(std::size_t nbufs) noexcept;
     native_stream_read_result  _do_readv(std::size_t nbufs) noexcept;
@@ -72,6 +109,20 @@ private:
     }
     native_stream_read_result _do_read_some(mutable_buffer buf) noexcept;
 
+    native_stream_write_result
+    _do_pwritev(std::uint64_t offset, std::size_t nbufs, rw_flags flags) noexcept;
+    native_stream_read_result
+    _do_preadv(std::uint64_t offset, std::size_t nbufs, rw_flags flags) noexcept;
+
+    native_stream_write_result
+    _do_write_some_at(std::uint64_t offset, const_buffer buf, rw_flags flags) noexcept;
+    native_stream_write_result
+    _do_write_some_at(std::uint64_t offset, mutable_buffer buf, rw_flags flags) noexcept {
+        return _do_write_some_at(offset, const_buffer(buf), flags);
+    }
+    native_stream_read_result
+    _do_read_some_at(std::uint64_t offset, mutable_buffer buf, rw_flags flags) noexcept;
+
     template <typename T>
     T _mk_result(std::ptrdiff_t n_transfered) {
         if (n_transfered == -1) {
@@ -86,8 +137,8 @@ private:
      * given buffer sequence.
      * @returns The number of elements in the iovec array.
      * @note this may not consume all elements of the buffer sequence, since
-     * the thread-local iovec array is statically sized and there is a limit
-     * to the number of elements we may insert into it.
+     * there is a limit to the number of elements that may be passed to a
+     * single vectored IO call.
      */
     template <typename T>
     std::size_t _prep_iovec(T&& bufs) noexcept {
@@ -96,12 +147,14 @@ private:
         using std::end;
         auto buf_iter = begin(bufs);
         auto buf_stop = end(bufs);
-        auto iov_it   = _tl_small_iov_array;
-        auto iov_end  = _tl_small_iov_array + _tl_iov_arr_len;
-        for (; iov_it != iov_end && buf_iter != buf_stop; ++iov_it, ++buf_iter, ++n_bufs) {
-            auto buf         = *buf_iter;
-            iov_it->iov_base = const_cast<std::byte*>(buf.data());
-            iov_it->iov_len  = buf.size();
+        for (; buf_iter != buf_stop; ++buf_iter, ++n_bufs) {
+            if (n_bufs == _tl_iov_arr_len && !_grow_tl_iov_array()) {
+                break;
+            }
+            auto  buf    = *buf_iter;
+            auto& iov    = _tl_iov_array[n_bufs];
+            iov.iov_base = const_cast<std::byte*>(buf.data());
+            iov.iov_len  = buf.size();
         }
         return n_bufs;
     }
@@ -117,6 +170,20 @@ private:
         auto n_bufs = _prep_iovec(bufs);
         return _do_writev(n_bufs);
     }
+
+    template <mutable_buffer_range T>
+    native_stream_read_result
+    _do_read_some_at(std::uint64_t offset, T&& bufs, rw_flags flags) noexcept {
+        auto n_bufs = _prep_iovec(bufs);
+        return _do_preadv(offset, n_bufs, flags);
+    }
+
+    template <buffer_range T>
+    native_stream_write_result
+    _do_write_some_at(std::uint64_t offset, T&& bufs, rw_flags flags) noexcept {
+        auto n_bufs = _prep_iovec(bufs);
+        return _do_pwritev(offset, n_bufs, flags);
+    }
 };
 
 #ifndef _WIN32
@@ -0,0 +1,78 @@
+#include <neo/io/stream/native.hpp>
+
+#include "../../../../testing/pipe.hpp"
+
+#include <catch2/catch.hpp>
+
+#ifndef _WIN32
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using neo::testing::make_pipe;
+
+TEST_CASE("Write many fragments with a single write_some") {
+    auto [in, out] = make_pipe();
+
+    std::vector<std::string>       parts;
+    std::vector<neo::const_buffer> bufs;
+    for (auto i = 0; i < 200; ++i) {
+        parts.push_back("<" + std::to_string(i) + ">");
+    }
+    std::string expect;
+    for (auto& part : parts) {
+        bufs.emplace_back(part);
+        expect += part;
+    }
+
+    auto res = out.write_some(bufs);
+    REQUIRE_FALSE(res.has_error());
+    CHECK(res.bytes_transferred == expect.size());
+
+    // Read it back in many fragments, too
+    std::string got;
+    got.resize(expect.size());
+    std::vector<neo::mutable_buffer> out_bufs;
+    for (auto remaining = neo::mutable_buffer(got); remaining.size(); remaining += 5) {
+        out_bufs.push_back(remaining.first(5));
+    }
+    auto rres = in.read_some(out_bufs);
+    REQUIRE_FALSE(rres.has_error());
+    CHECK(rres.bytes_transferred == expect.size());
+    CHECK(got == expect);
+}
+
+TEST_CASE("Vectored writes from several threads") {
+    auto [in, out] = make_pipe();
+
+    // Each thread writes one complete message as many fragments. Pipe writes
+    // smaller than PIPE_BUF are atomic, so the messages must not interleave.
+    const std::string msg = "abcdefghijklmnopqrstuvwxyz";
+    // Catch assertions may only be used on the main thread, so check the results after joining
+    std::vector<std::size_t> n_written(4);
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i < n_written.size(); ++i) {
+        threads.emplace_back([&, i, out = &out] {
+            std::vector<neo::const_buffer> bufs;
+            for (auto remaining = neo::const_buffer(msg); remaining.size(); remaining += 1) {
+                bufs.push_back(remaining.first(1));
+            }
+            n_written[i] = out->write_some(bufs).bytes_transferred;
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto n : n_written) {
+        CHECK(n == msg.size());
+    }
+
+    std::string got;
+    got.resize(msg.size() * 4);
+    auto res = in.read_some(neo::mutable_buffer(got));
+    REQUIRE_FALSE(res.has_error());
+    CHECK(got == msg + msg + msg + msg);
+}
+
+#endif
@@ -0,0 +1,206 @@
+#include "./resolver.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <new>
+
+#if NEO_OS_IS_UNIX_LIKE
+#include <netdb.h>
+#elif NEO_OS_IS_WINDOWS
+#include <WS2tcpip.h>
+#endif
+
+using namespace neo;
+
+namespace {
+
+std::string entry_key(const std::string& host, const std::string& service) {
+    std::string key;
+    key.reserve(host.size() + service.size() + 1);
+    key += host;
+    key += '\0';
+    key += service;
+    return key;
+}
+
+/// Whether the lookup failed because the name (or service) does not exist
+bool is_definite_failure(std::error_code ec) noexcept {
+    if (ec.category() != getaddrinfo_category()) {
+        return false;
+    }
+    switch (ec.value()) {
+    case EAI_NONAME:
+    case EAI_SERVICE:
+#if defined(EAI_NODATA) && EAI_NODATA != EAI_NONAME
+    case EAI_NODATA:
+#endif
+        return true;
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+resolver::resolver(options opts)
+    : _opts(opts) {
+    const auto n_threads = (std::max)(_opts.n_threads, std::size_t(1));
+    for (std::size_t i = 0; i < n_threads; ++i) {
+        _threads.emplace_back([this] { _worker(); });
+    }
+}
+
+resolver::~resolver() {
+    std::deque<entry_ptr> canceled;
+    {
+        std::unique_lock lk{_mtx};
+        _stopping = true;
+        canceled.swap(_queue);
+    }
+    _cv.notify_all();
+    for (auto& t : _threads) {
+        t.join();
+    }
+    for (auto& ent : canceled) {
+        for (auto& cb : ent->waiters) {
+            cb({}, make_error_code(std::errc::operation_canceled));
+        }
+    }
+}
+
+void resolver::_worker() noexcept {
+    std::unique_lock lk{_mtx};
+    while (true) {
+        _cv.wait(lk, [&] { return _stopping || !_queue.empty(); });
+        if (_stopping) {
+            return;
+        }
+        auto ent = std::move(_queue.front());
+        _queue.pop_front();
+        ++_stats.lookups;
+        lk.unlock();
+        std::error_code      ec;
+        std::vector<address> addrs;
+        try {
+            addrs = address::resolve_all(ent->host, ent->service, ec);
+        } catch (const std::bad_alloc&) {
+            // Not a definite failure, so it will not be cached
+            addrs.clear();
+            ec = make_error_code(std::errc::not_enough_memory);
+        }
+        _complete(ent, std::move(addrs), ec);
+        lk.lock();
+    }
+}
+
+void resolver::_complete(const entry_ptr&     ent,
+                         std::vector<address> addrs,
+                         std::error_code      ec) noexcept {
+    std::vector<callback> waiters;
+    {
+        std::unique_lock lk{_mtx};
+        const auto       now = clock::now();
+        ent->done            = true;
+        ent->addrs           = std::move(addrs);
+        ent->ec              = ec;
+        ent->expires         = now + (ec ? _opts.negative_ttl : _opts.ttl);
+        waiters.swap(ent->waiters);
+        if (ec && !is_definite_failure(ec)) {
+            // Don't remember transient failures: The next request should try again. Search by
+            // value rather than building the key, so that this cannot fail to allocate.
+            auto it = std::find_if(_entries.begin(), _entries.end(), [&](auto& pair) {
+                return pair.second == ent;
+            });
+            if (it != _entries.end()) {
+                _entries.erase(it);
+            }
+        }
+    }
+    for (auto& cb : waiters) {
+        cb(ent->addrs, ent->ec);
+    }
+}
+
+void resolver::_evict(clock::time_point now) noexcept {
+    std::erase_if(_entries, [&](auto& pair) {
+        auto& ent = *pair.second;
+        return ent.done && ent.expires <= now;
+    });
+    while (_entries.size() > _opts.max_entries) {
+        // Evict the completed entry that expires soonest
+        auto victim = _entries.end();
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->second->done
+                && (victim == _entries.end() || it->second->expires < victim->second->expires)) {
+                victim = it;
+            }
+        }
+        if (victim == _entries.end()) {
+            // Everything is still being looked up
+            break;
+        }
+        _entries.erase(victim);
+    }
+}
+
+void resolver::async_resolve(const std::string& host, const std::string& service, callback cb) {
+    auto             key = entry_key(host, service);
+    std::unique_lock lk{_mtx};
+    if (_stopping) {
+        lk.unlock();
+        cb({}, make_error_code(std::errc::operation_canceled));
+        return;
+    }
+    const auto now   = clock::now();
+    auto&      found = _entries[key];
+    if (found && found->done && found->expires > now) {
+        ++_stats.cache_hits;
+        // The entry may be evicted as soon as we unlock, so keep it alive.
+        auto ent = found;
+        lk.unlock();
+        cb(ent->addrs, ent->ec);
+        return;
+    }
+    if (found && !found->done) {
+        ++_stats.coalesced;
+        found->waiters.push_back(std::move(cb));
+        return;
+    }
+    auto ent     = std::make_shared<entry>();
+    ent->host    = host;
+    ent->service = service;
+    ent->waiters.push_back(std::move(cb));
+    found = ent;
+    if (_entries.size() > _opts.max_entries) {
+        _evict(now);
+    }
+    _queue.push_back(std::move(ent));
+    lk.unlock();
+    _cv.notify_one();
+}
+
+std::vector<address>
+resolver::resolve(const std::string& host, const std::string& service, std::error_code& ec) {
+    std::promise<std::vector<address>> result;
+    async_resolve(host, service, [&](const std::vector<address>& addrs, std::error_code res_ec) {
+        // Callbacks must not throw, so hand a failure to copy the result to our caller
+        try {
+            ec = res_ec;
+            result.set_value(addrs);
+        } catch (...) {
+            result.set_exception(std::current_exception());
+        }
+    });
+    return result.get_future().get();
+}
+
+void resolver::clear_cache() noexcept {
+    std::unique_lock lk{_mtx};
+    std::erase_if(_entries, [](auto& pair) { return pair.second->done; });
+}
+
+resolver::stats resolver::get_stats() const noexcept {
+    std::unique_lock lk{_mtx};
+    return _stats;
+}
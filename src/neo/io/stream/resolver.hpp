@@ -0,0 +1,137 @@
+#pragma once
+
+#include <neo/io/stream/socket.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace neo {
+
+/**
+ * @brief Resolves host names on a pool of background threads, caching the
+ * results.
+ *
+ * - Lookups call address::resolve_all() on one of the resolver's threads, so
+ *   the caller is never blocked by async_resolve().
+ * - Successful results are cached for `options::ttl`. Failures that mean the
+ *   name does not exist are cached for `options::negative_ttl`. Transient
+ *   failures (e.g. an unreachable DNS server) are not cached.
+ * - If a lookup for a host and service is already in progress, further
+ *   requests for it wait on that lookup rather than starting another.
+ *
+ * getaddrinfo() does not report the TTLs of DNS records, so the cache
+ * lifetimes are fixed by the options.
+ *
+ * All member functions are thread-safe. When the resolver is destroyed,
+ * callbacks for lookups that have not started are invoked with
+ * `operation_canceled`, and lookups that are in progress are waited for.
+ */
+class resolver {
+public:
+    struct options {
+        /// The number of threads that perform lookups
+        std::size_t n_threads = 2;
+        /// How long to cache successful results
+        std::chrono::milliseconds ttl = std::chrono::seconds(60);
+        /// How long to cache names that do not exist
+        std::chrono::milliseconds negative_ttl = std::chrono::seconds(5);
+        /// The most entries to keep in the cache. Expired entries are evicted first.
+        std::size_t max_entries = 1024;
+    };
+
+    /**
+     * @brief Invoked with the result of a lookup. If `ec` is set, the vector is
+     * empty. Otherwise it holds at least one address.
+     *
+     * Must not throw: the callback may be invoked on one of the resolver's
+     * threads, where an exception would terminate the process. A lookup that
+     * fails to allocate completes with `std::errc::not_enough_memory`.
+     */
+    using callback = std::function<void(const std::vector<address>&, std::error_code ec)>;
+
+    struct stats {
+        /// Lookups that were performed by calling getaddrinfo()
+        std::uint64_t lookups = 0;
+        /// Requests answered from the cache (including negative entries)
+        std::uint64_t cache_hits = 0;
+        /// Requests that joined a lookup that was already in progress
+        std::uint64_t coalesced = 0;
+    };
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct entry {
+        std::string           host;
+        std::string           service;
+        bool                  done = false;
+        std::vector<address>  addrs;
+        std::error_code       ec;
+        clock::time_point     expires;
+        std::vector<callback> waiters;
+    };
+
+    using entry_ptr = std::shared_ptr<entry>;
+
+    options                                    _opts;
+    mutable std::mutex                         _mtx;
+    std::condition_variable                    _cv;
+    std::unordered_map<std::string, entry_ptr> _entries;
+    std::deque<entry_ptr>                      _queue;
+    stats                                      _stats;
+    bool                                       _stopping = false;
+    std::vector<std::thread>                   _threads;
+
+    void _worker() noexcept;
+    void _complete(const entry_ptr&, std::vector<address>, std::error_code) noexcept;
+    void _evict(clock::time_point now) noexcept;
+
+public:
+    resolver()
+        : resolver(options{}) {}
+    explicit resolver(options opts);
+    ~resolver();
+
+    resolver(const resolver&) = delete;
+    resolver& operator=(const resolver&) = delete;
+
+    /**
+     * @brief Resolve the host and service, and invoke the callback with the
+     * result.
+     *
+     * If the answer is cached, the callback is invoked immediately on the
+     * calling thread. Otherwise it is invoked on one of the resolver's threads.
+     */
+    void async_resolve(const std::string& host, const std::string& service, callback cb);
+
+    /**
+     * @brief Resolve the host and service, blocking until the result is
+     * available. Uses and fills the cache like async_resolve().
+     */
+    std::vector<address>
+    resolve(const std::string& host, const std::string& service, std::error_code& ec);
+
+    std::vector<address> resolve(const std::string& host, const std::string& service) {
+        error_code_thrower err;
+        auto               addrs = resolve(host, service, err);
+        err("Failed to resolve host '{}' with service/port '{}'", host, service);
+        return addrs;
+    }
+
+    /// Drop all cached results. Lookups in progress are not affected.
+    void clear_cache() noexcept;
+
+    stats get_stats() const noexcept;
+};
+
+}  // namespace neo
@@ -0,0 +1,94 @@
+#include <neo/io/stream/resolver.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+TEST_CASE("Resolve all addresses of a host") {
+    auto addrs = neo::address::resolve_all("localhost", "80");
+    REQUIRE_FALSE(addrs.empty());
+    for (auto& addr : addrs) {
+        CHECK(addr.port() == 80);
+        // Duplicates are removed
+        CHECK(std::count(addrs.begin(), addrs.end(), addr) == 1);
+    }
+    CHECK(addrs.front() == neo::address::resolve("localhost", "80"));
+
+    std::error_code ec;
+    addrs = neo::address::resolve_all("localhost", "no-such-service-neo-io", ec);
+    CHECK(ec);
+    CHECK(addrs.empty());
+}
+
+TEST_CASE("Cache resolved addresses") {
+    neo::resolver res;
+    auto          addrs = res.resolve("localhost", "80");
+    CHECK(addrs == neo::address::resolve_all("localhost", "80"));
+    CHECK(res.resolve("localhost", "80") == addrs);
+
+    auto stats = res.get_stats();
+    CHECK(stats.lookups == 1);
+    CHECK(stats.cache_hits == 1);
+
+    // A different service is a different entry
+    res.resolve("localhost", "443");
+    CHECK(res.get_stats().lookups == 2);
+
+    res.clear_cache();
+    res.resolve("localhost", "80");
+    CHECK(res.get_stats().lookups == 3);
+}
+
+TEST_CASE("Cache names that do not exist") {
+    neo::resolver   res;
+    std::error_code ec;
+    res.resolve("localhost", "no-such-service-neo-io", ec);
+    CHECK(ec);
+    ec.clear();
+    auto addrs = res.resolve("localhost", "no-such-service-neo-io", ec);
+    CHECK(ec);
+    CHECK(addrs.empty());
+    CHECK(res.get_stats().lookups == 1);
+    CHECK(res.get_stats().cache_hits == 1);
+    CHECK_THROWS_AS(res.resolve("localhost", "no-such-service-neo-io"), std::system_error);
+}
+
+TEST_CASE("Expire cached addresses") {
+    neo::resolver res{{.ttl = std::chrono::milliseconds(0)}};
+    res.resolve("localhost", "80");
+    res.resolve("localhost", "80");
+    CHECK(res.get_stats().lookups == 2);
+    CHECK(res.get_stats().cache_hits == 0);
+}
+
+TEST_CASE("Coalesce concurrent lookups") {
+    neo::resolver res;
+
+    constexpr int      n_requests = 16;
+    std::atomic<int>   n_done{0};
+    std::atomic<int>   n_failed{0};
+    std::promise<void> all_done;
+    for (auto i = 0; i < n_requests; ++i) {
+        res.async_resolve("localhost",
+                          "80",
+                          [&](const std::vector<neo::address>& addrs, std::error_code ec) {
+                              // The callbacks run on the resolver's threads, so
+                              // only count failures here
+                              if (ec || addrs.empty()) {
+                                  ++n_failed;
+                              }
+                              if (++n_done == n_requests) {
+                                  all_done.set_value();
+                              }
+                          });
+    }
+    all_done.get_future().wait();
+    CHECK(n_failed == 0);
+    // Every request after the first either joined the lookup or hit the cache
+    auto stats = res.get_stats();
+    CHECK(stats.lookups == 1);
+    CHECK(stats.coalesced + stats.cache_hits == n_requests - 1);
+}
@@ -11,6 +11,21 @@ struct native_transfer_result {
     int            errn              = 0;
     constexpr bool has_error() const noexcept { return errn != 0; }
     auto           error() const noexcept { return std::error_code(errn, std::system_category()); }
+
+    /**
+     * Determine whether the transfer failed only because a non-blocking stream
+     * was not ready. The operation should be retried once the stream reports
+     * readiness. Such a result is still an error according to `has_error()`.
+     */
+    constexpr bool would_block() const noexcept {
+        return errn == static_cast<int>(std::errc::operation_would_block)
+            || errn == static_cast<int>(std::errc::resource_unavailable_try_again)
+#ifdef _WIN32
+            // WSAEWOULDBLOCK
+            || errn == 10035
+#endif
+            ;
+    }
 };
 
 struct native_stream_read_result : native_transfer_result {};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <neo/enum.hpp>
+
+namespace neo {
+
+/**
+ * @brief Per-operation flags for positional reads and writes (read_some_at()
+ * and write_some_at()).
+ *
+ * On Linux these correspond to the RWF_* flags of preadv2() and pwritev2().
+ * If a flag is not supported by the system, the operation fails with
+ * `std::errc::operation_not_supported`.
+ */
+enum class rw_flags : unsigned {
+    /// No flags set
+    none = 0,
+    /// Do not wait for data that is not immediately available (e.g. in the page
+    /// cache). The operation fails with `would_block()` instead. (RWF_NOWAIT)
+    nowait = 1,
+    /// Make a write durable before returning, as if by fdatasync(). (RWF_DSYNC)
+    dsync = 1 << 1,
+    /// Make a write durable before returning, as if by fsync(). (RWF_SYNC)
+    sync = 1 << 2,
+    /// Poll for completion of the operation. Only meaningful for direct I/O. (RWF_HIPRI)
+    high_priority = 1 << 3,
+};
+
+NEO_DECL_ENUM_BITOPS(rw_flags);
+
+}  // namespace neo
@@ -2,22 +2,121 @@
 
 #include <neo/event.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cstring>
+#include <memory>
+#include <new>
 #include <ostream>
 
 #if NEO_OS_IS_UNIX_LIKE
+#include <arpa/inet.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
 static int last_error_code() noexcept { return errno; }
+using io_length_t = std::size_t;
 #elif NEO_OS_IS_WINDOWS
 #include <WS2tcpip.h>
 static int last_error_code() noexcept { return ::WSAGetLastError(); }
+using io_length_t = int;
+#endif
+
+#if __linux__
+#include <netinet/udp.h>
+#include <sys/uio.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
 #endif
 
 using namespace neo;
 
 namespace {
 
+struct addrinfo_deleter {
+    void operator()(::addrinfo* ai) const noexcept { ::freeaddrinfo(ai); }
+};
+
+struct native_sockopt {
+    int level;
+    int name;
+};
+
+/// The level and name of the option, or nullopt if this platform does not have it
+std::optional<native_sockopt> get_native_sockopt(socket_option_id id,
+                                                 address::family  fam) noexcept {
+    switch (id) {
+    case socket_option_id::tcp_nodelay:
+        return native_sockopt{IPPROTO_TCP, TCP_NODELAY};
+    case socket_option_id::tcp_cork:
+#if defined(TCP_CORK)
+        return native_sockopt{IPPROTO_TCP, TCP_CORK};
+#elif defined(TCP_NOPUSH)
+        return native_sockopt{IPPROTO_TCP, TCP_NOPUSH};
+#else
+        break;
+#endif
+    case socket_option_id::tcp_quickack:
+#if defined(TCP_QUICKACK)
+        return native_sockopt{IPPROTO_TCP, TCP_QUICKACK};
+#else
+        break;
+#endif
+    case socket_option_id::send_buffer_size:
+        return native_sockopt{SOL_SOCKET, SO_SNDBUF};
+    case socket_option_id::recv_buffer_size:
+        return native_sockopt{SOL_SOCKET, SO_RCVBUF};
+    case socket_option_id::busy_poll:
+#if defined(SO_BUSY_POLL)
+        return native_sockopt{SOL_SOCKET, SO_BUSY_POLL};
+#else
+        break;
+#endif
+    case socket_option_id::tcp_notsent_lowat:
+#if defined(TCP_NOTSENT_LOWAT)
+        return native_sockopt{IPPROTO_TCP, TCP_NOTSENT_LOWAT};
+#else
+        break;
+#endif
+    case socket_option_id::keepalive:
+        return native_sockopt{SOL_SOCKET, SO_KEEPALIVE};
+    case socket_option_id::tcp_keepalive_idle:
+#if defined(TCP_KEEPIDLE)
+        return native_sockopt{IPPROTO_TCP, TCP_KEEPIDLE};
+#elif defined(TCP_KEEPALIVE)
+        return native_sockopt{IPPROTO_TCP, TCP_KEEPALIVE};
+#else
+        break;
+#endif
+    case socket_option_id::tcp_keepalive_interval:
+#if defined(TCP_KEEPINTVL)
+        return native_sockopt{IPPROTO_TCP, TCP_KEEPINTVL};
+#else
+        break;
+#endif
+    case socket_option_id::tcp_keepalive_count:
+#if defined(TCP_KEEPCNT)
+        return native_sockopt{IPPROTO_TCP, TCP_KEEPCNT};
+#else
+        break;
+#endif
+    case socket_option_id::ip_tos:
+        if (fam == address::family::inet6) {
+            return native_sockopt{IPPROTO_IPV6, IPV6_TCLASS};
+        }
+        return native_sockopt{IPPROTO_IP, IP_TOS};
+    }
+    return std::nullopt;
+}
+
 class getaddrinfo_category_t : public std::error_category {
     const char* name() const noexcept override { return "getaddrinfo"; }
 
@@ -53,32 +152,69 @@ address::family address::get_family() const noexcept {
     }
 }
 
+std::uint16_t address::port() const noexcept {
+    switch (get_family()) {
+    case family::inet:
+        return ntohs(reinterpret_cast<const ::sockaddr_in*>(_storage.data())->sin_port);
+    case family::inet6:
+        return ntohs(reinterpret_cast<const ::sockaddr_in6*>(_storage.data())->sin6_port);
+    default:
+        return 0;
+    }
+}
+
 std::optional<address> address::resolve(const std::string& host,
                                         const std::string& service,
                                         std::error_code&   ec) noexcept {
+    try {
+        auto all = resolve_all(host, service, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        return all.front();
+    } catch (const std::bad_alloc&) {
+        ec = make_error_code(std::errc::not_enough_memory);
+        return std::nullopt;
+    }
+}
+
+std::vector<address> address::resolve_all(const std::string& host,
+                                          const std::string& service,
+                                          std::error_code&   ec) {
     io_detail::init_sockets();
     neo::emit(ev_resolve{host, service});
     ::addrinfo* res = nullptr;
     auto        rc  = ::getaddrinfo(host.data(), service.data(), nullptr, &res);
     if (rc != 0) {
         ec = std::error_code(rc, getaddrinfo_category());
-        return std::nullopt;
+        return {};
+    }
+    // Free the list even if building the result throws
+    std::unique_ptr<::addrinfo, addrinfo_deleter> res_guard{res};
+    std::vector<address>                          ret;
+    static_assert(sizeof(address::_storage) >= sizeof(sockaddr_storage));
+    for (auto ai = res; ai; ai = ai->ai_next) {
+        neo_assert(invariant,
+                   ai->ai_addrlen <= sizeof(address::_storage),
+                   "Resolved address has a size greater than we can store. Huh?",
+                   ai->ai_addrlen,
+                   sizeof(address::_storage),
+                   host,
+                   service,
+                   ai->ai_family,
+                   ai->ai_protocol,
+                   ai->ai_socktype);
+        address addr;
+        std::memcpy(&addr._storage, ai->ai_addr, ai->ai_addrlen);
+        addr._size = ai->ai_addrlen;
+        // getaddrinfo() gives one result for each socket type of each address
+        if (std::find(ret.begin(), ret.end(), addr) == ret.end()) {
+            ret.push_back(addr);
+        }
+    }
+    if (ret.empty()) {
+        ec = std::error_code(EAI_NONAME, getaddrinfo_category());
     }
-    address ret;
-    static_assert(sizeof(ret._storage) >= sizeof(sockaddr_storage));
-    neo_assert(invariant,
-               res->ai_addrlen <= sizeof(ret._storage),
-               "Resolved address has a size greater than we can store. Huh?",
-               res->ai_addrlen,
-               sizeof(ret._storage),
-               host,
-               service,
-               res->ai_family,
-               res->ai_protocol,
-               res->ai_socktype);
-    std::memcpy(&ret._storage, res->ai_addr, res->ai_addrlen);
-    ret._size = res->ai_addrlen;
-    ::freeaddrinfo(res);
     return ret;
 }
 
@@ -140,3 +276,529 @@ void socket::connect(address addr, std::error_code& ec) noexcept {
         ec = std::error_code(last_error_code(), std::system_category());
     }
 }
+
+void socket::bind(address addr, std::error_code& ec) noexcept {
+    io_detail::init_sockets();
+    auto rc = ::bind(_stream.native_handle(),
+                     reinterpret_cast<const ::sockaddr*>(&addr._storage),
+                     static_cast<::socklen_t>(addr._size));
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+    }
+}
+
+void socket::listen(int backlog, std::error_code& ec) noexcept {
+    auto rc = ::listen(_stream.native_handle(), backlog);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+    }
+}
+
+address socket::local_address(std::error_code& ec) const noexcept {
+    address ret;
+    auto    len = static_cast<::socklen_t>(ret._storage.size());
+    auto    rc  = ::getsockname(_stream.native_handle(),
+                            reinterpret_cast<::sockaddr*>(ret._storage.data()),
+                            &len);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return {};
+    }
+    ret._size = static_cast<std::size_t>(len);
+    return ret;
+}
+
+address socket::peer_address(std::error_code& ec) const noexcept {
+    address ret;
+    auto    len = static_cast<::socklen_t>(ret._storage.size());
+    auto    rc  = ::getpeername(_stream.native_handle(),
+                            reinterpret_cast<::sockaddr*>(ret._storage.data()),
+                            &len);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return {};
+    }
+    ret._size = static_cast<std::size_t>(len);
+    return ret;
+}
+
+std::string_view neo::socket_option_name(socket_option_id id) noexcept {
+    switch (id) {
+    case socket_option_id::tcp_nodelay:
+        return "TCP_NODELAY";
+    case socket_option_id::tcp_cork:
+        return "TCP_CORK";
+    case socket_option_id::tcp_quickack:
+        return "TCP_QUICKACK";
+    case socket_option_id::send_buffer_size:
+        return "SO_SNDBUF";
+    case socket_option_id::recv_buffer_size:
+        return "SO_RCVBUF";
+    case socket_option_id::busy_poll:
+        return "SO_BUSY_POLL";
+    case socket_option_id::tcp_notsent_lowat:
+        return "TCP_NOTSENT_LOWAT";
+    case socket_option_id::keepalive:
+        return "SO_KEEPALIVE";
+    case socket_option_id::tcp_keepalive_idle:
+        return "TCP_KEEPIDLE";
+    case socket_option_id::tcp_keepalive_interval:
+        return "TCP_KEEPINTVL";
+    case socket_option_id::tcp_keepalive_count:
+        return "TCP_KEEPCNT";
+    case socket_option_id::ip_tos:
+        return "IP_TOS";
+    }
+    return "<unknown>";
+}
+
+void socket::_set_option(socket_option_id id, int value, std::error_code& ec) noexcept {
+    // The family is only needed to tell IP_TOS from IPV6_TCLASS
+    std::error_code fam_ec;
+    const auto      fam
+        = id == socket_option_id::ip_tos ? local_address(fam_ec).get_family() : address::family{};
+    auto opt = get_native_sockopt(id, fam);
+    if (!opt) {
+        ec = make_error_code(std::errc::not_supported);
+        return;
+    }
+    auto rc = ::setsockopt(_stream.native_handle(),
+                           opt->level,
+                           opt->name,
+                           reinterpret_cast<const char*>(&value),
+                           sizeof value);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+    }
+}
+
+int socket::_get_option(socket_option_id id, std::error_code& ec) const noexcept {
+    std::error_code fam_ec;
+    const auto      fam
+        = id == socket_option_id::ip_tos ? local_address(fam_ec).get_family() : address::family{};
+    auto opt = get_native_sockopt(id, fam);
+    if (!opt) {
+        ec = make_error_code(std::errc::not_supported);
+        return 0;
+    }
+    int  value = 0;
+    auto len   = static_cast<::socklen_t>(sizeof value);
+    auto rc    = ::getsockopt(_stream.native_handle(),
+                           opt->level,
+                           opt->name,
+                           reinterpret_cast<char*>(&value),
+                           &len);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    return value;
+}
+
+std::vector<address> io_detail::interleave_address_families(std::span<const address> addrs) {
+    std::vector<address> ret;
+    ret.reserve(addrs.size());
+    if (addrs.empty()) {
+        return ret;
+    }
+    const auto           first_fam = addrs.front().get_family();
+    std::vector<address> preferred;
+    std::vector<address> others;
+    for (auto& addr : addrs) {
+        (addr.get_family() == first_fam ? preferred : others).push_back(addr);
+    }
+    for (std::size_t i = 0; i < (std::max)(preferred.size(), others.size()); ++i) {
+        if (i < preferred.size()) {
+            ret.push_back(preferred[i]);
+        }
+        if (i < others.size()) {
+            ret.push_back(others[i]);
+        }
+    }
+    return ret;
+}
+
+std::optional<neo::socket> socket::open_connected(std::span<const address> addrs,
+                                                  type                     typ,
+                                                  const connect_options&   options,
+                                                  std::error_code&         ec) noexcept {
+    using clock = std::chrono::steady_clock;
+
+    const auto order = io_detail::interleave_address_families(addrs);
+    if (order.empty()) {
+        ec = make_error_code(std::errc::invalid_argument);
+        return std::nullopt;
+    }
+
+    std::vector<socket> attempts;
+    /// Whether each attempt has finished, successfully or not
+    std::vector<bool> finished;
+#if !NEO_OS_IS_WINDOWS
+    std::vector<::pollfd> pollfds;
+#endif
+    std::size_t     n_started = 0;
+    std::error_code last_ec;
+
+    // Start the next attempt. Returns the socket if it connected immediately.
+    auto start_next = [&]() -> std::optional<socket> {
+        while (n_started < order.size()) {
+            auto&           addr = order[n_started++];
+            std::error_code attempt_ec;
+            auto            s = create(addr.get_family(), typ, attempt_ec);
+            if (s) {
+                s->set_nonblocking(true, attempt_ec);
+            }
+            if (!attempt_ec) {
+                s->connect(addr, attempt_ec);
+                if (!attempt_ec) {
+                    return s;
+                }
+            }
+            if (attempt_ec == std::errc::operation_in_progress
+                || attempt_ec == std::errc::operation_would_block) {
+                attempts.push_back(std::move(*s));
+                return std::nullopt;
+            }
+            last_ec = attempt_ec;
+        }
+        return std::nullopt;
+    };
+
+    auto won = [&](socket& s) -> std::optional<socket> {
+        s.set_nonblocking(false, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        return std::move(s);
+    };
+
+    const auto deadline
+        = options.timeout ? clock::now() + *options.timeout : clock::time_point::max();
+    auto next_start = clock::now();
+    while (true) {
+        auto now = clock::now();
+        if (now >= next_start && n_started < order.size()) {
+            if (auto s = start_next()) {
+                return won(*s);
+            }
+            next_start = now + options.attempt_delay;
+        }
+        if (attempts.empty()) {
+            if (n_started == order.size()) {
+                ec = last_ec;
+                return std::nullopt;
+            }
+            // Every attempt so far failed immediately. Don't wait to start the next.
+            next_start = now;
+            continue;
+        }
+        if (now >= deadline) {
+            ec = make_error_code(std::errc::timed_out);
+            return std::nullopt;
+        }
+
+        auto wake_at = deadline;
+        if (n_started < order.size()) {
+            wake_at = (std::min)(wake_at, next_start);
+        }
+        // Round up, so that we do not spin for the last fraction of a millisecond
+        auto wait_ms = std::chrono::ceil<std::chrono::milliseconds>(wake_at - now).count();
+        wait_ms      = (std::min)(wait_ms, decltype(wait_ms)(INT_MAX));
+
+        finished.assign(attempts.size(), false);
+#if NEO_OS_IS_WINDOWS
+        // WSAPoll() does not report a failed non-blocking connect() before Windows 10 2004, so
+        // use select(), which reports the failure in the except set.
+        ::fd_set wfds;
+        ::fd_set efds;
+        FD_ZERO(&wfds);
+        FD_ZERO(&efds);
+        for (auto& s : attempts) {
+            FD_SET(static_cast<::SOCKET>(s._stream.native_handle()), &wfds);
+            FD_SET(static_cast<::SOCKET>(s._stream.native_handle()), &efds);
+        }
+        ::timeval tv = {};
+        tv.tv_sec    = static_cast<long>(wait_ms / 1000);
+        tv.tv_usec   = static_cast<long>((wait_ms % 1000) * 1000);
+        auto rc      = ::select(0, nullptr, &wfds, &efds, &tv);
+        if (rc > 0) {
+            for (std::size_t i = 0; i < attempts.size(); ++i) {
+                auto h      = static_cast<::SOCKET>(attempts[i]._stream.native_handle());
+                finished[i] = FD_ISSET(h, &wfds) || FD_ISSET(h, &efds);
+            }
+        }
+#else
+        pollfds.clear();
+        for (auto& s : attempts) {
+            ::pollfd pfd = {};
+            pfd.fd       = static_cast<decltype(pfd.fd)>(s._stream.native_handle());
+            pfd.events   = POLLOUT;
+            pollfds.push_back(pfd);
+        }
+        auto rc = ::poll(pollfds.data(), pollfds.size(), int(wait_ms));
+        if (rc > 0) {
+            for (std::size_t i = 0; i < attempts.size(); ++i) {
+                finished[i] = pollfds[i].revents != 0;
+            }
+        }
+#endif
+        if (rc < 0) {
+            if (last_error_code() == EINTR) {
+                continue;
+            }
+            ec = std::error_code(last_error_code(), std::system_category());
+            return std::nullopt;
+        }
+
+        // Check the attempts that finished. Go backwards so that failures may be erased.
+        for (auto i = attempts.size(); i-- > 0;) {
+            if (!finished[i]) {
+                continue;
+            }
+            int  err = 0;
+            auto len = static_cast<::socklen_t>(sizeof err);
+            if (::getsockopt(attempts[i]._stream.native_handle(),
+                             SOL_SOCKET,
+                             SO_ERROR,
+                             reinterpret_cast<char*>(&err),
+                             &len)) {
+                err = last_error_code();
+            }
+            if (err == 0) {
+                return won(attempts[i]);
+            }
+            last_ec = std::error_code(err, std::system_category());
+            attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+            // A failed attempt frees us to start the next one right away
+            next_start = clock::now();
+        }
+    }
+}
+
+std::size_t socket::send_to(const_buffer data, const address& to, std::error_code& ec) noexcept {
+    auto rc = ::sendto(_stream.native_handle(),
+                       reinterpret_cast<const char*>(data.data()),
+                       static_cast<io_length_t>(data.size()),
+                       0,
+                       reinterpret_cast<const ::sockaddr*>(to._storage.data()),
+                       static_cast<::socklen_t>(to._size));
+    if (rc < 0) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    return static_cast<std::size_t>(rc);
+}
+
+std::size_t socket::recv_from(mutable_buffer data, address& from, std::error_code& ec) noexcept {
+    auto len = static_cast<::socklen_t>(from._storage.size());
+    auto rc  = ::recvfrom(_stream.native_handle(),
+                         reinterpret_cast<char*>(data.data()),
+                         static_cast<io_length_t>(data.size()),
+                         0,
+                         reinterpret_cast<::sockaddr*>(from._storage.data()),
+                         &len);
+    if (rc < 0) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    from._size = static_cast<std::size_t>(len);
+    return static_cast<std::size_t>(rc);
+}
+
+#if __linux__
+
+namespace {
+
+/// Space for the one control message that we send or receive with each datagram
+union datagram_cmsg_buf {
+    ::cmsghdr align;
+    char      buf[CMSG_SPACE(sizeof(int))];
+};
+
+/**
+ * Per-thread arrays for sendmmsg()/recvmmsg(), so that batches do not
+ * allocate once the arrays have grown to the batch size.
+ */
+struct mmsg_arrays {
+    std::vector<::mmsghdr>         hdrs;
+    std::vector<::iovec>           iovs;
+    std::vector<datagram_cmsg_buf> cmsgs;
+
+    void prepare(std::size_t n) {
+        if (hdrs.size() < n) {
+            hdrs.resize(n);
+            iovs.resize(n);
+            cmsgs.resize(n);
+        }
+        std::memset(hdrs.data(), 0, n * sizeof(::mmsghdr));
+    }
+};
+
+thread_local mmsg_arrays tl_mmsg_arrays;
+
+/// The most datagrams that we pass to a single sendmmsg()/recvmmsg()
+constexpr std::size_t max_mmsg_batch = UIO_MAXIOV;
+
+}  // namespace
+
+std::size_t socket::send_batch(std::span<const datagram_out> msgs, std::error_code& ec) noexcept {
+    const auto n   = (std::min)(msgs.size(), max_mmsg_batch);
+    auto&      arr = tl_mmsg_arrays;
+    arr.prepare(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto& msg   = msgs[i];
+        auto& hdr   = arr.hdrs[i].msg_hdr;
+        arr.iovs[i] = {const_cast<std::byte*>(msg.data.data()), msg.data.size()};
+        hdr.msg_iov = &arr.iovs[i];
+        hdr.msg_iovlen = 1;
+        if (msg.to) {
+            hdr.msg_name    = const_cast<std::byte*>(msg.to->_storage.data());
+            hdr.msg_namelen = static_cast<::socklen_t>(msg.to->_size);
+        }
+        if (msg.segment_size) {
+            hdr.msg_control    = arr.cmsgs[i].buf;
+            hdr.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+            auto cm            = CMSG_FIRSTHDR(&hdr);
+            cm->cmsg_level     = SOL_UDP;
+            cm->cmsg_type      = UDP_SEGMENT;
+            cm->cmsg_len       = CMSG_LEN(sizeof(std::uint16_t));
+            std::memcpy(CMSG_DATA(cm), &msg.segment_size, sizeof(std::uint16_t));
+        }
+    }
+    auto rc = ::sendmmsg(_stream.native_handle(), arr.hdrs.data(), static_cast<unsigned>(n), 0);
+    if (rc < 0) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    return static_cast<std::size_t>(rc);
+}
+
+std::size_t socket::recv_batch(std::span<datagram_in> msgs, std::error_code& ec) noexcept {
+    const auto n   = (std::min)(msgs.size(), max_mmsg_batch);
+    auto&      arr = tl_mmsg_arrays;
+    arr.prepare(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto& msg          = msgs[i];
+        auto& hdr          = arr.hdrs[i].msg_hdr;
+        arr.iovs[i]        = {msg.data.data(), msg.data.size()};
+        hdr.msg_iov        = &arr.iovs[i];
+        hdr.msg_iovlen     = 1;
+        hdr.msg_name       = msg.from._storage.data();
+        hdr.msg_namelen    = static_cast<::socklen_t>(msg.from._storage.size());
+        hdr.msg_control    = arr.cmsgs[i].buf;
+        hdr.msg_controllen = sizeof(datagram_cmsg_buf);
+    }
+    auto rc = ::recvmmsg(_stream.native_handle(),
+                         arr.hdrs.data(),
+                         static_cast<unsigned>(n),
+                         MSG_WAITFORONE,
+                         nullptr);
+    if (rc < 0) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(rc); ++i) {
+        auto& msg         = msgs[i];
+        auto& hdr         = arr.hdrs[i].msg_hdr;
+        msg.size          = arr.hdrs[i].msg_len;
+        msg.from._size    = hdr.msg_namelen;
+        msg.truncated     = (hdr.msg_flags & MSG_TRUNC) != 0;
+        msg.segment_size  = 0;
+        for (auto cm = CMSG_FIRSTHDR(&hdr); cm; cm = CMSG_NXTHDR(&hdr, cm)) {
+            if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                int seg = 0;
+                std::memcpy(&seg, CMSG_DATA(cm), sizeof seg);
+                msg.segment_size = static_cast<std::size_t>(seg);
+            }
+        }
+    }
+    return static_cast<std::size_t>(rc);
+}
+
+void socket::set_udp_gro(bool enable, std::error_code& ec) noexcept {
+    int  val = enable ? 1 : 0;
+    auto rc  = ::setsockopt(_stream.native_handle(), SOL_UDP, UDP_GRO, &val, sizeof val);
+    if (rc) {
+        ec = std::error_code(last_error_code(), std::system_category());
+    }
+}
+
+#else
+
+// Without sendmmsg()/recvmmsg(), send one datagram at a time, and receive only one per call.
+
+std::size_t socket::send_batch(std::span<const datagram_out> msgs, std::error_code& ec) noexcept {
+    std::size_t n_sent = 0;
+    for (auto& msg : msgs) {
+        if (msg.segment_size) {
+            ec = make_error_code(std::errc::not_supported);
+        } else if (msg.to) {
+            send_to(msg.data, *msg.to, ec);
+        } else {
+            ec = write_some(msg.data).error();
+        }
+        if (ec) {
+            break;
+        }
+        ++n_sent;
+    }
+    if (n_sent != 0) {
+        // The caller will see the error when it tries to send the remainder
+        ec.clear();
+    }
+    return n_sent;
+}
+
+std::size_t socket::recv_batch(std::span<datagram_in> msgs, std::error_code& ec) noexcept {
+    if (msgs.empty()) {
+        return 0;
+    }
+    auto& msg        = msgs.front();
+    msg.segment_size = 0;
+#if NEO_OS_IS_UNIX_LIKE
+    // Use recvmsg() rather than recvfrom() so that we can see MSG_TRUNC
+    ::iovec  iov = {msg.data.data(), msg.data.size()};
+    ::msghdr hdr = {};
+    hdr.msg_name    = msg.from._storage.data();
+    hdr.msg_namelen = static_cast<::socklen_t>(msg.from._storage.size());
+    hdr.msg_iov     = &iov;
+    hdr.msg_iovlen  = 1;
+    auto rc         = ::recvmsg(_stream.native_handle(), &hdr, 0);
+    if (rc < 0) {
+        ec = std::error_code(last_error_code(), std::system_category());
+        return 0;
+    }
+    msg.size       = static_cast<std::size_t>(rc);
+    msg.from._size = static_cast<std::size_t>(hdr.msg_namelen);
+    msg.truncated  = (hdr.msg_flags & MSG_TRUNC) != 0;
+#else
+    auto len = static_cast<::socklen_t>(msg.from._storage.size());
+    auto rc  = ::recvfrom(_stream.native_handle(),
+                         reinterpret_cast<char*>(msg.data.data()),
+                         static_cast<io_length_t>(msg.data.size()),
+                         0,
+                         reinterpret_cast<::sockaddr*>(msg.from._storage.data()),
+                         &len);
+    msg.truncated = false;
+    if (rc < 0) {
+        auto err = last_error_code();
+        if (err != WSAEMSGSIZE) {
+            ec = std::error_code(err, std::system_category());
+            return 0;
+        }
+        // Windows fills the buffer with the start of a datagram that is too
+        // large, and then fails with WSAEMSGSIZE
+        rc            = static_cast<decltype(rc)>(msg.data.size());
+        msg.truncated = true;
+    }
+    msg.size       = static_cast<std::size_t>(rc);
+    msg.from._size = static_cast<std::size_t>(len);
+#endif
+    return 1;
+}
+
+void socket::set_udp_gro(bool, std::error_code& ec) noexcept {
+    ec = make_error_code(std::errc::not_supported);
+}
+
+#endif
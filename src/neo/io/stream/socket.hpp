@@ -6,9 +6,15 @@
 #include <neo/platform.hpp>
 
 #include <array>
+#include <chrono>
 #include <cinttypes>
+#include <concepts>
+#include <functional>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <system_error>
+#include <vector>
 
 namespace neo {
 
@@ -92,6 +98,8 @@ public:
     ~wsa_socket_stream() { shutdown(); }
     void shutdown();
 
+    void set_nonblocking(bool, std::error_code& ec) noexcept;
+
     constexpr native_handle_type native_handle() const noexcept { return _native_handle; }
 
     void reset(native_handle_type&& sock) noexcept {
@@ -143,6 +151,12 @@ public:
 
     family get_family() const noexcept;
 
+    /**
+     * @brief Get the port number of an inet or inet6 address. Returns zero for
+     * other address families.
+     */
+    std::uint16_t port() const noexcept;
+
     static std::optional<address>
     resolve(const std::string& host, const std::string& service, std::error_code&) noexcept;
 
@@ -152,11 +166,240 @@ public:
         err("Failed to resolve host '{}' with service/port '{}'", host, service);
         return *addr;
     }
+
+    /**
+     * @brief Resolve all addresses of the given host and service, in the order
+     * given by getaddrinfo(). Duplicate addresses are removed. The result is
+     * never empty unless an error occurs.
+     *
+     * This blocks the caller. See `neo::resolver` for asynchronous, cached
+     * resolution. Lookup failures are reported through the error_code, but
+     * building the result may throw std::bad_alloc.
+     */
+    static std::vector<address>
+    resolve_all(const std::string& host, const std::string& service, std::error_code&);
+
+    static std::vector<address> resolve_all(const std::string& host, const std::string& service) {
+        error_code_thrower err;
+        auto               addrs = resolve_all(host, service, err);
+        err("Failed to resolve host '{}' with service/port '{}'", host, service);
+        return addrs;
+    }
+
+    bool operator==(const address&) const noexcept = default;
+
+    /// Hash the address, e.g. for use as a key in a hash table
+    std::size_t hash() const noexcept {
+        return std::hash<std::string_view>{}(
+            std::string_view(reinterpret_cast<const char*>(_storage.data()), _size));
+    }
+};
+
+/**
+ * @brief A datagram to be sent with socket::send_batch().
+ */
+struct datagram_out {
+    const_buffer data;
+    /// The destination. May be null if the socket is connected.
+    const address* to = nullptr;
+    /**
+     * If non-zero, `data` holds several datagrams of this size (the last may
+     * be shorter), which are split up by the kernel or the network card (UDP
+     * generic segmentation offload). Linux only.
+     */
+    std::uint16_t segment_size = 0;
+};
+
+/**
+ * @brief Receives a datagram from socket::recv_batch().
+ */
+struct datagram_in {
+    /// The buffer that receives the datagram
+    mutable_buffer data;
+    /// Receives the address of the sender
+    address from;
+    /// The number of bytes received into `data`
+    std::size_t size = 0;
+    /**
+     * If UDP generic receive offload is enabled (see socket::set_udp_gro()),
+     * `data` may hold several datagrams from the same sender that were
+     * coalesced by the kernel. This is then the size of each one, except the
+     * last, which may be shorter. Zero if `data` holds a single datagram.
+     */
+    std::size_t segment_size = 0;
+    /// Whether the datagram was larger than `data` and the excess was discarded
+    bool truncated = false;
+};
+
+namespace io_detail {
+
+/**
+ * Order addresses for connection attempts as in RFC 8305 section 4: alternate
+ * between address families, beginning with the family of the first address,
+ * and otherwise keeping the given order.
+ */
+std::vector<address> interleave_address_families(std::span<const address> addrs);
+
+}  // namespace io_detail
+
+/**
+ * @brief Identifies a socket option. See the option types in neo::sockopt.
+ */
+enum class socket_option_id {
+    tcp_nodelay,
+    tcp_cork,
+    tcp_quickack,
+    send_buffer_size,
+    recv_buffer_size,
+    busy_poll,
+    tcp_notsent_lowat,
+    keepalive,
+    tcp_keepalive_idle,
+    tcp_keepalive_interval,
+    tcp_keepalive_count,
+    ip_tos,
+};
+
+/// Get the name of the native option, e.g. "TCP_NODELAY"
+std::string_view socket_option_name(socket_option_id) noexcept;
+
+/**
+ * @brief Typed socket options, for use with socket::set_option(),
+ * socket::get_option(), and when creating a socket.
+ *
+ * Each option has a single `value`. Setting or getting an option that the
+ * platform does not have fails with `std::errc::not_supported`.
+ */
+namespace sockopt {
+
+/// TCP_NODELAY: Send small segments immediately, rather than coalescing them (Nagle's algorithm)
+struct tcp_nodelay {
+    constexpr static auto id = socket_option_id::tcp_nodelay;
+    bool                  value;
+};
+
+/**
+ * TCP_CORK: Hold back partial segments until the option is cleared (or for at
+ * most 200ms). Uses TCP_NOPUSH on the BSDs.
+ */
+struct tcp_cork {
+    constexpr static auto id = socket_option_id::tcp_cork;
+    bool                  value;
+};
+
+/**
+ * TCP_QUICKACK: Send ACKs immediately rather than delaying them. The kernel
+ * may clear this by itself, so it must be set again after each read to stay
+ * in effect. Linux only.
+ */
+struct tcp_quickack {
+    constexpr static auto id = socket_option_id::tcp_quickack;
+    bool                  value;
+};
+
+/**
+ * SO_SNDBUF: The size of the kernel's send buffer. Linux doubles the given
+ * size to leave room for bookkeeping, and reports the doubled size.
+ */
+struct send_buffer_size {
+    constexpr static auto id = socket_option_id::send_buffer_size;
+    int                   value;
+};
+
+/// SO_RCVBUF: The size of the kernel's receive buffer. See send_buffer_size.
+struct recv_buffer_size {
+    constexpr static auto id = socket_option_id::recv_buffer_size;
+    int                   value;
+};
+
+/**
+ * SO_BUSY_POLL: How long a blocking read may spin on the device queue before
+ * sleeping. Raising it above the system default requires CAP_NET_ADMIN.
+ * Linux only.
+ */
+struct busy_poll {
+    constexpr static auto     id = socket_option_id::busy_poll;
+    std::chrono::microseconds value;
+};
+
+/**
+ * TCP_NOTSENT_LOWAT: Report the socket as writable only while fewer than this
+ * many bytes are waiting to be sent, which keeps data from going stale in the
+ * send buffer.
+ */
+struct tcp_notsent_lowat {
+    constexpr static auto id = socket_option_id::tcp_notsent_lowat;
+    std::uint32_t         value;
+};
+
+/// SO_KEEPALIVE: Probe idle connections to detect a dead peer
+struct keepalive {
+    constexpr static auto id = socket_option_id::keepalive;
+    bool                  value;
+};
+
+/// TCP_KEEPIDLE: How long a connection is idle before the first keepalive probe
+struct tcp_keepalive_idle {
+    constexpr static auto id = socket_option_id::tcp_keepalive_idle;
+    std::chrono::seconds  value;
 };
 
+/// TCP_KEEPINTVL: The time between keepalive probes
+struct tcp_keepalive_interval {
+    constexpr static auto id = socket_option_id::tcp_keepalive_interval;
+    std::chrono::seconds  value;
+};
+
+/// TCP_KEEPCNT: The number of unanswered probes after which the connection is dropped
+struct tcp_keepalive_count {
+    constexpr static auto id = socket_option_id::tcp_keepalive_count;
+    int                   value;
+};
+
+/// IP_TOS: The type-of-service (DSCP and ECN) byte. Sets IPV6_TCLASS on IPv6 sockets.
+struct ip_tos {
+    constexpr static auto id = socket_option_id::ip_tos;
+    std::uint8_t          value;
+};
+
+}  // namespace sockopt
+
+template <typename T>
+concept socket_option = requires(const T& opt) {
+    { T::id } -> std::convertible_to<socket_option_id>;
+    opt.value;
+};
+
+namespace io_detail {
+
+template <typename T>
+constexpr int sockopt_to_int(T value) noexcept {
+    if constexpr (requires { value.count(); }) {
+        return static_cast<int>(value.count());
+    } else {
+        return static_cast<int>(value);
+    }
+}
+
+template <typename T>
+constexpr T sockopt_from_int(int value) noexcept {
+    if constexpr (std::same_as<T, bool>) {
+        return value != 0;
+    } else if constexpr (requires { T(value).count(); }) {
+        return T(value);
+    } else {
+        return static_cast<T>(value);
+    }
+}
+
+}  // namespace io_detail
+
 class socket {
     io_detail::native_socket_stream _stream;
 
+    void _set_option(socket_option_id, int value, std::error_code& ec) noexcept;
+    int  _get_option(socket_option_id, std::error_code& ec) const noexcept;
+
 public:
     enum class type {
         stream,
@@ -167,6 +410,18 @@ public:
         const address& addr;
     };
 
+    /**
+     * @brief Options for connecting to one of several addresses. See
+     * open_connected(std::span<const address>, type, const connect_options&).
+     */
+    struct connect_options {
+        /// How long to wait on an attempt before starting the next in parallel. RFC 8305
+        /// recommends 250ms, and no less than 10ms.
+        std::chrono::milliseconds attempt_delay = std::chrono::milliseconds(250);
+        /// How long to wait for any attempt to succeed. If nullopt, there is no limit.
+        std::optional<std::chrono::milliseconds> timeout;
+    };
+
     socket()         = default;
     socket(socket&&) = default;
     socket& operator=(socket&&) = default;
@@ -176,13 +431,39 @@ public:
     auto& native() const noexcept { return _stream; }
 
     static std::optional<socket> create(address::family, type, std::error_code& ec) noexcept;
-    static socket                create(address::family fam, type ty) {
-        return *create(fam, ty, "Failed to create a new socket"_ec_throw);
+
+    /**
+     * @brief Create a socket, and set the given options on it.
+     */
+    template <socket_option... Opts>
+    static std::optional<socket>
+    create(address::family fam, type ty, std::error_code& ec, const Opts&... opts) noexcept {
+        auto s = create(fam, ty, ec);
+        if (s) {
+            ((ec ? void() : s->set_option(opts, ec)), ...);
+        }
+        if (ec) {
+            return {};
+        }
+        return s;
+    }
+
+    template <socket_option... Opts>
+    static socket create(address::family fam, type ty, const Opts&... opts) {
+        return *create(fam, ty, "Failed to create a new socket"_ec_throw, opts...);
     }
 
+    /**
+     * @brief Create a socket with the given options and connect it.
+     *
+     * The options are set before connecting, which is required for some of
+     * them to take full effect (e.g. the TCP window scale for a large receive
+     * buffer is negotiated during the handshake).
+     */
+    template <socket_option... Opts>
     static std::optional<socket>
-    open_connected(address addr, type typ, std::error_code& ec) noexcept {
-        auto s = create(addr.get_family(), typ, ec);
+    open_connected(address addr, type typ, std::error_code& ec, const Opts&... opts) noexcept {
+        auto s = create(addr.get_family(), typ, ec, opts...);
         if (s) {
             s->connect(addr, ec);
         }
@@ -192,12 +473,181 @@ public:
         return s;
     }
 
-    static socket open_connected(address addr, type typ) {
-        return *open_connected(addr, typ, "Failed to connect socket"_ec_throw);
+    template <socket_option... Opts>
+    static socket open_connected(address addr, type typ, const Opts&... opts) {
+        return *open_connected(addr, typ, "Failed to connect socket"_ec_throw, opts...);
+    }
+
+    /**
+     * @brief Connect to whichever of the addresses accepts the connection
+     * first, using the "Happy Eyeballs" algorithm of RFC 8305.
+     *
+     * The addresses are ordered to alternate between IPv6 and IPv4 (beginning
+     * with the family of the first address). A connection attempt is started
+     * for the first address. If it has not succeeded after
+     * `options.attempt_delay`, or as soon as it fails, an attempt is started
+     * for the next address, while earlier attempts continue. The first attempt
+     * to succeed wins, and the others are abandoned.
+     *
+     * This blocks the caller, and returns a socket in blocking mode. If every
+     * attempt fails, `ec` is set to the error of the last attempt to fail.
+     */
+    static std::optional<socket> open_connected(std::span<const address> addrs,
+                                                type                     typ,
+                                                const connect_options&   options,
+                                                std::error_code&         ec) noexcept;
+
+    static socket open_connected(std::span<const address> addrs,
+                                 type                     typ,
+                                 const connect_options&   options) {
+        return *open_connected(addrs, typ, options, "Failed to connect socket"_ec_throw);
+    }
+    static socket open_connected(std::span<const address> addrs, type typ) {
+        return open_connected(addrs, typ, connect_options{});
     }
 
+    /**
+     * @brief Connect the socket to the given address.
+     *
+     * If the socket is in non-blocking mode, this will usually fail with
+     * `std::errc::operation_in_progress`, and the connection will complete
+     * asynchronously. Wait for the socket to become writable before using it.
+     */
     void connect(address addr, std::error_code& ec) noexcept;
 
+    /**
+     * @brief Bind the socket to the given local address.
+     */
+    void bind(address addr, std::error_code& ec) noexcept;
+    void bind(address addr) { bind(addr, "Failed to bind socket to address"_ec_throw); }
+
+    /**
+     * @brief Begin listening for incoming connections on a bound socket.
+     *
+     * @param backlog The maximum length of the queue of pending connections
+     */
+    void listen(int backlog, std::error_code& ec) noexcept;
+    void listen(int backlog) { listen(backlog, "Failed to listen on socket"_ec_throw); }
+
+    /**
+     * @brief Get the local address to which the socket is bound.
+     */
+    address local_address(std::error_code& ec) const noexcept;
+    address local_address() const {
+        return local_address("Failed to get the local address of a socket"_ec_throw);
+    }
+
+    /**
+     * @brief Get the address of the peer to which the socket is connected.
+     */
+    address peer_address(std::error_code& ec) const noexcept;
+    address peer_address() const {
+        return peer_address("Failed to get the peer address of a socket"_ec_throw);
+    }
+
+    /**
+     * @brief Enable or disable non-blocking mode on the socket.
+     *
+     * In non-blocking mode, read_some() and write_some() return immediately
+     * with a result for which `would_block()` is `true` if the socket is not
+     * ready. Use a `neo::reactor` to wait for readiness.
+     */
+    void set_nonblocking(bool nonblocking, std::error_code& ec) noexcept {
+        _stream.set_nonblocking(nonblocking, ec);
+    }
+    void set_nonblocking(bool nonblocking) {
+        set_nonblocking(nonblocking, "Failed to change the blocking mode of a socket"_ec_throw);
+    }
+
+    /**
+     * @brief Send a single datagram to the given address.
+     *
+     * @return The number of bytes sent
+     */
+    std::size_t send_to(const_buffer data, const address& to, std::error_code& ec) noexcept;
+    std::size_t send_to(const_buffer data, const address& to) {
+        return send_to(data, to, "Failed to send a datagram"_ec_throw);
+    }
+
+    /**
+     * @brief Receive a single datagram, and the address of its sender.
+     *
+     * @return The number of bytes received. If the datagram is larger than
+     * `data`, the excess is discarded.
+     */
+    std::size_t recv_from(mutable_buffer data, address& from, std::error_code& ec) noexcept;
+    std::size_t recv_from(mutable_buffer data, address& from) {
+        return recv_from(data, from, "Failed to receive a datagram"_ec_throw);
+    }
+
+    /**
+     * @brief Send a batch of datagrams, using as few system calls as possible
+     * (a single sendmmsg() on Linux).
+     *
+     * @return The number of elements of `msgs` that were sent. If this is less
+     * than `msgs.size()` and `ec` is not set, the remainder may be sent with
+     * another call.
+     */
+    std::size_t send_batch(std::span<const datagram_out> msgs, std::error_code& ec) noexcept;
+    std::size_t send_batch(std::span<const datagram_out> msgs) {
+        return send_batch(msgs, "Failed to send datagrams"_ec_throw);
+    }
+
+    /**
+     * @brief Receive a batch of datagrams, using as few system calls as
+     * possible (a single recvmmsg() on Linux).
+     *
+     * Waits for (at least) one datagram, unless the socket is non-blocking.
+     * Then receives as many more as are already queued, up to `msgs.size()`.
+     *
+     * @return The number of elements of `msgs` that were filled.
+     */
+    std::size_t recv_batch(std::span<datagram_in> msgs, std::error_code& ec) noexcept;
+    std::size_t recv_batch(std::span<datagram_in> msgs) {
+        return recv_batch(msgs, "Failed to receive datagrams"_ec_throw);
+    }
+
+    /**
+     * @brief Enable or disable UDP generic receive offload. When enabled,
+     * recv_batch() may receive several datagrams from one sender in a single
+     * datagram_in. Fails with `not_supported` on platforms other than Linux.
+     */
+    void set_udp_gro(bool enable, std::error_code& ec) noexcept;
+    void set_udp_gro(bool enable) {
+        set_udp_gro(enable, "Failed to set UDP generic receive offload"_ec_throw);
+    }
+
+    /**
+     * @brief Set a socket option. See neo::sockopt.
+     */
+    template <socket_option Opt>
+    void set_option(const Opt& opt, std::error_code& ec) noexcept {
+        _set_option(Opt::id, io_detail::sockopt_to_int(opt.value), ec);
+    }
+    template <socket_option Opt>
+    void set_option(const Opt& opt) {
+        error_code_thrower err;
+        set_option(opt, err);
+        err("Failed to set socket option {}", socket_option_name(Opt::id));
+    }
+
+    /**
+     * @brief Get the value of a socket option, as it is in effect (which may
+     * differ from the value that was set).
+     */
+    template <socket_option Opt>
+    Opt get_option(std::error_code& ec) const noexcept {
+        using value_type = decltype(Opt::value);
+        return Opt{io_detail::sockopt_from_int<value_type>(_get_option(Opt::id, ec))};
+    }
+    template <socket_option Opt>
+    Opt get_option() const {
+        error_code_thrower err;
+        auto               opt = get_option<Opt>(err);
+        err("Failed to get socket option {}", socket_option_name(Opt::id));
+        return opt;
+    }
+
     template <buffer_range Bufs>
     auto write_some(Bufs&& b) noexcept requires requires {
         _stream.write_some(b);
@@ -212,3 +662,8 @@ public:
 };
 
 }  // namespace neo
+
+template <>
+struct std::hash<neo::address> {
+    std::size_t operator()(const neo::address& addr) const noexcept { return addr.hash(); }
+};
@@ -1,12 +1,19 @@
 #include <neo/io/stream/socket.hpp>
 
+#include "../../../../testing/socket_pair.hpp"
+
 #include <neo/io/read.hpp>
+#include <neo/io/stream/listener.hpp>
 #include <neo/io/write.hpp>
 
 #include <neo/string_io.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <span>
+#include <string>
+#include <vector>
+
 TEST_CASE("Open a connected socket") {
     CHECK_THROWS_AS(neo::socket::
                         open_connected(neo::address::resolve("google.com.this.tld.does.not.exist",
@@ -38,4 +45,236 @@ TEST_CASE("Open to a non-connected port") {
     } catch (const std::system_error& e) {
         CHECK(e.code() == std::errc::connection_refused);
     }
-}
\ No newline at end of file
+}
+
+namespace {
+
+neo::socket open_udp_loopback() {
+    auto sock = neo::socket::create(neo::address::family::inet, neo::socket::type::datagram);
+    sock.bind(neo::address::resolve("127.0.0.1", "0"));
+    return sock;
+}
+
+}  // namespace
+
+TEST_CASE("Send and receive a datagram") {
+    auto a = open_udp_loopback();
+    auto b = open_udp_loopback();
+
+    auto n = a.send_to(neo::const_buffer("Hello, datagram"), b.local_address());
+    CHECK(n == 15);
+
+    std::string  buf(64, '\0');
+    neo::address from;
+    n = b.recv_from(neo::mutable_buffer(buf), from);
+    CHECK(buf.substr(0, n) == "Hello, datagram");
+    CHECK(from == a.local_address());
+}
+
+TEST_CASE("Send and receive batches of datagrams") {
+    auto a = open_udp_loopback();
+    auto b = open_udp_loopback();
+
+    const auto                     b_addr = b.local_address();
+    std::vector<std::string>       payloads;
+    std::vector<neo::datagram_out> out;
+    for (auto i = 0; i < 32; ++i) {
+        payloads.push_back("datagram #" + std::to_string(i));
+    }
+    for (auto& p : payloads) {
+        out.push_back({neo::const_buffer(p), &b_addr});
+    }
+    std::size_t n_sent = 0;
+    while (n_sent < out.size()) {
+        n_sent += a.send_batch(std::span(out).subspan(n_sent));
+    }
+
+    std::vector<std::string>      bufs(64, std::string(64, '\0'));
+    std::vector<neo::datagram_in> in;
+    for (auto& buf : bufs) {
+        in.push_back({neo::mutable_buffer(buf)});
+    }
+    std::vector<std::string> got;
+    while (got.size() < payloads.size()) {
+        auto n = b.recv_batch(in);
+        REQUIRE(n > 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            CHECK(in[i].from == a.local_address());
+            CHECK_FALSE(in[i].truncated);
+            got.push_back(bufs[i].substr(0, in[i].size));
+        }
+    }
+    CHECK(got == payloads);
+
+    // A datagram larger than the buffer is truncated
+    std::string big(100, 'x');
+    a.send_to(neo::const_buffer(big), b_addr);
+    std::string small(10, '\0');
+    in.resize(1);
+    in[0].data = neo::mutable_buffer(small);
+    CHECK(b.recv_batch(in) == 1);
+    CHECK(in[0].size == 10);
+    CHECK(in[0].truncated);
+}
+
+#if __linux__
+TEST_CASE("Send and receive segmented datagrams") {
+    auto a = open_udp_loopback();
+    auto b = open_udp_loopback();
+    b.set_udp_gro(true);
+
+    // Ten datagrams of 100 bytes each, sent in one buffer
+    std::string payload;
+    for (auto i = 0; i < 10; ++i) {
+        payload.append(100, static_cast<char>('0' + i));
+    }
+    const auto        b_addr = b.local_address();
+    neo::datagram_out out{neo::const_buffer(payload), &b_addr, 100};
+    CHECK(a.send_batch(std::span(&out, 1)) == 1);
+
+    // They may arrive coalesced again, or as separate datagrams
+    std::string                   buf(64 * 1024, '\0');
+    std::vector<neo::datagram_in> in(1);
+    std::string                   got;
+    std::size_t                   n_datagrams = 0;
+    while (got.size() < payload.size()) {
+        in[0].data = neo::mutable_buffer(buf);
+        REQUIRE(b.recv_batch(in) == 1);
+        got += buf.substr(0, in[0].size);
+        if (in[0].segment_size) {
+            CHECK(in[0].segment_size == 100);
+            n_datagrams += (in[0].size + 99) / 100;
+        } else {
+            CHECK(in[0].size == 100);
+            ++n_datagrams;
+        }
+    }
+    CHECK(got == payload);
+    CHECK(n_datagrams == 10);
+}
+#endif
+
+TEST_CASE("Set and get socket options") {
+    using namespace std::chrono_literals;
+    auto sock = neo::socket::create(neo::address::family::inet,
+                                    neo::socket::type::stream,
+                                    neo::sockopt::tcp_nodelay{true},
+                                    neo::sockopt::recv_buffer_size{256 * 1024});
+    CHECK(sock.get_option<neo::sockopt::tcp_nodelay>().value);
+    // The kernel may round the size up (Linux doubles it), but never down
+    CHECK(sock.get_option<neo::sockopt::recv_buffer_size>().value >= 256 * 1024);
+
+    sock.set_option(neo::sockopt::tcp_nodelay{false});
+    CHECK_FALSE(sock.get_option<neo::sockopt::tcp_nodelay>().value);
+
+    sock.set_option(neo::sockopt::send_buffer_size{64 * 1024});
+    CHECK(sock.get_option<neo::sockopt::send_buffer_size>().value >= 64 * 1024);
+
+    sock.set_option(neo::sockopt::keepalive{true});
+    CHECK(sock.get_option<neo::sockopt::keepalive>().value);
+
+    sock.set_option(neo::sockopt::ip_tos{0x10});
+    CHECK(sock.get_option<neo::sockopt::ip_tos>().value == 0x10);
+
+#if __linux__
+    sock.set_option(neo::sockopt::tcp_keepalive_idle{30s});
+    sock.set_option(neo::sockopt::tcp_keepalive_interval{5s});
+    sock.set_option(neo::sockopt::tcp_keepalive_count{3});
+    CHECK(sock.get_option<neo::sockopt::tcp_keepalive_idle>().value == 30s);
+    CHECK(sock.get_option<neo::sockopt::tcp_keepalive_interval>().value == 5s);
+    CHECK(sock.get_option<neo::sockopt::tcp_keepalive_count>().value == 3);
+
+    sock.set_option(neo::sockopt::tcp_cork{true});
+    CHECK(sock.get_option<neo::sockopt::tcp_cork>().value);
+
+    sock.set_option(neo::sockopt::tcp_notsent_lowat{16 * 1024});
+    CHECK(sock.get_option<neo::sockopt::tcp_notsent_lowat>().value == 16 * 1024);
+
+    sock.set_option(neo::sockopt::tcp_quickack{true});
+    sock.get_option<neo::sockopt::busy_poll>();
+#endif
+
+    // Options that do not apply to the socket's protocol are reported as errors
+    auto udp = open_udp_loopback();
+    CHECK_THROWS_AS(udp.set_option(neo::sockopt::tcp_nodelay{true}), std::system_error);
+    std::error_code ec;
+    udp.get_option<neo::sockopt::tcp_nodelay>(ec);
+    CHECK(ec);
+}
+
+TEST_CASE("Interleave address families for connection attempts") {
+    auto v4_a = neo::address::resolve("127.0.0.1", "1");
+    auto v4_b = neo::address::resolve("127.0.0.2", "1");
+    auto v4_c = neo::address::resolve("127.0.0.3", "1");
+    auto v6_a = neo::address::resolve("::1", "1");
+    auto v6_b = neo::address::resolve("::2", "1");
+
+    std::vector<neo::address> addrs = {v6_a, v6_b, v4_a, v4_b, v4_c};
+    CHECK(neo::io_detail::interleave_address_families(addrs)
+          == std::vector<neo::address>{v6_a, v4_a, v6_b, v4_b, v4_c});
+    addrs = {v4_a, v6_a, v4_b, v4_c, v6_b};
+    CHECK(neo::io_detail::interleave_address_families(addrs)
+          == std::vector<neo::address>{v4_a, v6_a, v4_b, v6_b, v4_c});
+}
+
+TEST_CASE("Connect to the first address that accepts") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto          refused = [] {
+        // Bind to a port, then close it, so that connecting is refused
+        neo::listener closed{neo::address::resolve("127.0.0.1", "0")};
+        return closed.local_address();
+    }();
+
+    neo::socket::connect_options opts;
+    opts.attempt_delay = std::chrono::milliseconds(20);
+    opts.timeout       = std::chrono::seconds(5);
+
+    std::vector<neo::address> addrs = {refused, refused, lis.local_address()};
+    auto sock = neo::socket::open_connected(addrs, neo::socket::type::stream, opts);
+    CHECK(sock.peer_address() == lis.local_address());
+
+    // The socket is left in blocking mode
+    auto server = neo::testing::accept_blocking(lis);
+    neo::write(server, neo::const_buffer("ping"));
+    std::string buf(4, '\0');
+    neo::read(sock, neo::mutable_buffer(buf));
+    CHECK(buf == "ping");
+
+    addrs = {refused, refused};
+    std::error_code ec;
+    CHECK_FALSE(neo::socket::open_connected(addrs, neo::socket::type::stream, opts, ec));
+    CHECK(ec == std::errc::connection_refused);
+
+    ec = {};
+    CHECK_FALSE(neo::socket::open_connected({}, neo::socket::type::stream, opts, ec));
+    CHECK(ec == std::errc::invalid_argument);
+}
+
+#if __linux__
+TEST_CASE("Start the next connection attempt when one stalls") {
+    // A listener whose accept queue is full drops new SYNs, so connecting to it stalls
+    auto stalled = neo::socket::create(neo::address::family::inet, neo::socket::type::stream);
+    stalled.bind(neo::address::resolve("127.0.0.1", "0"));
+    stalled.listen(0);
+    auto filler = neo::socket::open_connected(stalled.local_address(), neo::socket::type::stream);
+
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+
+    neo::socket::connect_options opts;
+    opts.attempt_delay = std::chrono::milliseconds(50);
+
+    std::vector<neo::address> addrs = {stalled.local_address(), lis.local_address()};
+    auto       start = std::chrono::steady_clock::now();
+    auto       sock  = neo::socket::open_connected(addrs, neo::socket::type::stream, opts);
+    const auto took  = std::chrono::steady_clock::now() - start;
+    CHECK(sock.peer_address() == lis.local_address());
+    CHECK(took < std::chrono::milliseconds(900));
+
+    // With only the stalled address, the attempt times out
+    opts.timeout = std::chrono::milliseconds(100);
+    std::error_code ec;
+    addrs = {stalled.local_address()};
+    CHECK_FALSE(neo::socket::open_connected(addrs, neo::socket::type::stream, opts, ec));
+    CHECK(ec == std::errc::timed_out);
+}
+#endif
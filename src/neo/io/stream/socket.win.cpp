@@ -17,6 +17,13 @@ void io_detail::wsa_socket_stream::shutdown() {
     }
 }
 
+void io_detail::wsa_socket_stream::set_nonblocking(bool nonblocking, std::error_code& ec) noexcept {
+    u_long mode = nonblocking ? 1 : 0;
+    if (::ioctlsocket(native_handle(), FIONBIO, &mode) != 0) {
+        ec = std::error_code(::WSAGetLastError(), std::system_category());
+    }
+}
+
 native_stream_write_result
 io_detail::wsa_socket_stream::_do_write_some(const_buffer cbuf) noexcept {
     ::WSABUF buf{.len = static_cast<ULONG>(cbuf.size()),
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <neo/io/concepts/result.hpp>
+
+#include <neo/assert.hpp>
+#include <neo/buffer_algorithm.hpp>
+#include <neo/const_buffer.hpp>
+#include <neo/mutable_buffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+namespace neo {
+
+namespace io_detail {
+
+constexpr std::size_t spsc_cache_line_size = 64;
+
+/**
+ * The ring buffer shared by the two ends of an spsc_pipe. The positions are
+ * byte counts that only ever increase, shifted left by one. The low bit is
+ * set when the end that owns the position is closed.
+ */
+struct spsc_ring {
+    /// Owned by the reader: the number of bytes consumed
+    alignas(spsc_cache_line_size) std::atomic<std::size_t> head{0};
+    /// Owned by the writer: the number of bytes produced
+    alignas(spsc_cache_line_size) std::atomic<std::size_t> tail{0};
+
+    alignas(spsc_cache_line_size) const std::size_t capacity;
+    const std::unique_ptr<std::byte[]> data;
+
+    /// The number of ends blocked in wait_change(). The mutex and condition
+    /// variable are only used once an end has to block.
+    std::atomic<int>        n_waiting{0};
+    std::mutex              wait_mutex;
+    std::condition_variable wait_cv;
+
+    explicit spsc_ring(std::size_t cap)
+        : capacity(cap)
+        , data(new std::byte[cap]) {}
+
+    constexpr static std::size_t closed_bit = 1;
+
+    constexpr static std::size_t pos_bytes(std::size_t pos) noexcept { return pos >> 1; }
+    constexpr static bool        pos_closed(std::size_t pos) noexcept { return pos & closed_bit; }
+
+    /// The (up to) two segments of the ring beginning at byte `pos`, of `n` bytes in total
+    std::array<mutable_buffer, 2> segments(std::size_t pos, std::size_t n) const noexcept {
+        const auto idx   = pos & (capacity - 1);
+        const auto first = (std::min)(n, capacity - idx);
+        return {mutable_buffer(data.get() + idx, first), mutable_buffer(data.get(), n - first)};
+    }
+
+    /// Block until `pos` holds a value other than `old`
+    void wait_change(const std::atomic<std::size_t>& pos, std::size_t old) noexcept {
+        std::unique_lock lk{wait_mutex};
+        n_waiting.fetch_add(1);
+        wait_cv.wait(lk, [&] { return pos.load() != old; });
+        n_waiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Wake the other end if it is blocked in wait_change(). Call this after
+    /// modifying a position.
+    void notify() noexcept {
+        // Pairs with the increment of n_waiting: either we see the waiter, or
+        // the waiter sees the new position.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (n_waiting.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        // Taking the lock ensures the waiter is either blocked already or has
+        // yet to check the position.
+        { std::lock_guard lk{wait_mutex}; }
+        wait_cv.notify_all();
+    }
+};
+
+}  // namespace io_detail
+
+/**
+ * @brief The reading end of an spsc_pipe. See make_spsc_pipe().
+ */
+class spsc_pipe_reader {
+    std::shared_ptr<io_detail::spsc_ring> _ring;
+    /// Bytes consumed so far. Only this end modifies the ring's head.
+    std::size_t _head = 0;
+    /// The most recently observed ring tail. The tail is only loaded again
+    /// when a read asks for more than we know to be there, so that the reader
+    /// and writer touch each other's cache lines as rarely as possible.
+    std::size_t _tail_cache = 0;
+    bool        _nonblocking = false;
+
+public:
+    spsc_pipe_reader() = default;
+    explicit spsc_pipe_reader(std::shared_ptr<io_detail::spsc_ring> r) noexcept
+        : _ring(std::move(r)) {}
+
+    spsc_pipe_reader(spsc_pipe_reader&& o) noexcept
+        : _ring(std::move(o._ring))
+        , _head(o._head)
+        , _tail_cache(o._tail_cache)
+        , _nonblocking(o._nonblocking) {}
+
+    spsc_pipe_reader& operator=(spsc_pipe_reader&& o) noexcept {
+        close();
+        _ring        = std::move(o._ring);
+        _head        = o._head;
+        _tail_cache  = o._tail_cache;
+        _nonblocking = o._nonblocking;
+        return *this;
+    }
+
+    ~spsc_pipe_reader() { close(); }
+
+    /**
+     * @brief Close the reading end. Further writes to the pipe will fail with
+     * `broken_pipe`.
+     */
+    void close() noexcept {
+        if (_ring) {
+            _ring->head.fetch_or(io_detail::spsc_ring::closed_bit, std::memory_order_release);
+            _ring->notify();
+            _ring.reset();
+        }
+    }
+
+    /**
+     * @brief In non-blocking mode, reading from an empty pipe fails with
+     * `operation_would_block` rather than waiting for the writer.
+     */
+    void set_nonblocking(bool nb) noexcept { _nonblocking = nb; }
+
+    /// The number of bytes that may be read without waiting
+    std::size_t available() noexcept {
+        _tail_cache = _ring->tail.load(std::memory_order_acquire);
+        return io_detail::spsc_ring::pos_bytes(_tail_cache) - _head;
+    }
+
+    /**
+     * @brief Read from the pipe into the buffers, from both segments of the
+     * ring if the data wraps around.
+     *
+     * Returns zero bytes without an error once the writer is closed and all
+     * data has been read.
+     */
+    template <mutable_buffer_range Bufs>
+    basic_transfer_result read_some(Bufs&& dest) noexcept {
+        neo_assert(expects, !!_ring, "read_some() on a closed spsc_pipe_reader");
+        using ring_t = io_detail::spsc_ring;
+        auto& ring   = *_ring;
+        if (ring_t::pos_bytes(_tail_cache) - _head < buffer_size(dest)) {
+            // We know of less data than was requested. Check for more.
+            _tail_cache = ring.tail.load(std::memory_order_acquire);
+            while (ring_t::pos_bytes(_tail_cache) == _head) {
+                if (ring_t::pos_closed(_tail_cache)) {
+                    return {};
+                }
+                if (_nonblocking) {
+                    return {0, make_error_code(std::errc::operation_would_block)};
+                }
+                ring.wait_change(ring.tail, _tail_cache);
+                _tail_cache = ring.tail.load(std::memory_order_acquire);
+            }
+        }
+        const auto avail = ring_t::pos_bytes(_tail_cache) - _head;
+        const auto n     = buffer_copy(dest, ring.segments(_head, avail));
+        _head += n;
+        ring.head.store(_head << 1, std::memory_order_release);
+        ring.notify();
+        return {n};
+    }
+};
+
+/**
+ * @brief The writing end of an spsc_pipe. See make_spsc_pipe().
+ */
+class spsc_pipe_writer {
+    std::shared_ptr<io_detail::spsc_ring> _ring;
+    /// Bytes produced so far. Only this end modifies the ring's tail.
+    std::size_t _tail = 0;
+    /// The most recently observed ring head. See spsc_pipe_reader::_tail_cache.
+    std::size_t _head_cache  = 0;
+    bool        _nonblocking = false;
+
+public:
+    spsc_pipe_writer() = default;
+    explicit spsc_pipe_writer(std::shared_ptr<io_detail::spsc_ring> r) noexcept
+        : _ring(std::move(r)) {}
+
+    spsc_pipe_writer(spsc_pipe_writer&& o) noexcept
+        : _ring(std::move(o._ring))
+        , _tail(o._tail)
+        , _head_cache(o._head_cache)
+        , _nonblocking(o._nonblocking) {}
+
+    spsc_pipe_writer& operator=(spsc_pipe_writer&& o) noexcept {
+        close();
+        _ring        = std::move(o._ring);
+        _tail        = o._tail;
+        _head_cache  = o._head_cache;
+        _nonblocking = o._nonblocking;
+        return *this;
+    }
+
+    ~spsc_pipe_writer() { close(); }
+
+    /**
+     * @brief Close the writing end. The reader will see the end of the stream
+     * once it has read the remaining data.
+     */
+    void close() noexcept {
+        if (_ring) {
+            _ring->tail.fetch_or(io_detail::spsc_ring::closed_bit, std::memory_order_release);
+            _ring->notify();
+            _ring.reset();
+        }
+    }
+
+    /**
+     * @brief In non-blocking mode, writing to a full pipe fails with
+     * `operation_would_block` rather than waiting for the reader.
+     */
+    void set_nonblocking(bool nb) noexcept { _nonblocking = nb; }
+
+    /// The total number of bytes the pipe can hold
+    std::size_t capacity() const noexcept { return _ring->capacity; }
+
+    /**
+     * @brief Write the buffers into the pipe, into both segments of the ring
+     * if the free space wraps around.
+     *
+     * Fails with `broken_pipe` if the reader has been closed. Like a socket
+     * whose peer has gone away, the writer may not notice a closed reader
+     * until it runs out of the free space that it has already seen.
+     */
+    template <buffer_range Bufs>
+    basic_transfer_result write_some(Bufs&& src) noexcept {
+        neo_assert(expects, !!_ring, "write_some() on a closed spsc_pipe_writer");
+        using ring_t = io_detail::spsc_ring;
+        auto& ring   = *_ring;
+        auto  space  = [&] { return ring.capacity - (_tail - ring_t::pos_bytes(_head_cache)); };
+        if (space() < buffer_size(src)) {
+            // We know of less space than was requested. Check for more.
+            _head_cache = ring.head.load(std::memory_order_acquire);
+            while (space() == 0 && !ring_t::pos_closed(_head_cache)) {
+                if (_nonblocking) {
+                    return {0, make_error_code(std::errc::operation_would_block)};
+                }
+                ring.wait_change(ring.head, _head_cache);
+                _head_cache = ring.head.load(std::memory_order_acquire);
+            }
+            if (ring_t::pos_closed(_head_cache)) {
+                return {0, make_error_code(std::errc::broken_pipe)};
+            }
+        }
+        const auto n = buffer_copy(ring.segments(_tail, space()), src);
+        _tail += n;
+        ring.tail.store(_tail << 1, std::memory_order_release);
+        ring.notify();
+        return {n};
+    }
+};
+
+/**
+ * @brief Create an in-memory pipe for handing bytes from one thread to
+ * another, without locks.
+ *
+ * One thread may write to the writer while another reads from the reader.
+ * The pipe is a fixed-size ring buffer: the storage is allocated once, here,
+ * and the pipe never allocates afterward. Reads and writes block while the
+ * pipe is empty or full, unless the end is set to be non-blocking. Only an end
+ * that has to block takes a lock.
+ *
+ * @param min_capacity The number of bytes the pipe must be able to hold. This
+ * is rounded up to a power of two.
+ */
+inline std::pair<spsc_pipe_reader, spsc_pipe_writer> make_spsc_pipe(std::size_t min_capacity) {
+    neo_assert(expects, min_capacity > 0, "An spsc_pipe must have a non-zero capacity");
+    auto ring = std::make_shared<io_detail::spsc_ring>(std::bit_ceil(min_capacity));
+    return {spsc_pipe_reader(ring), spsc_pipe_writer(ring)};
+}
+
+}  // namespace neo
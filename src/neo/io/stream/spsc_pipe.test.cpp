@@ -0,0 +1,113 @@
+#include <neo/io/stream/spsc_pipe.hpp>
+
+#include <neo/io/read.hpp>
+#include <neo/io/write.hpp>
+
+#include <neo/test_concept.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+NEO_TEST_CONCEPT(neo::read_stream<neo::spsc_pipe_reader>);
+NEO_TEST_CONCEPT(neo::vectored_read_stream<neo::spsc_pipe_reader>);
+NEO_TEST_CONCEPT(neo::write_stream<neo::spsc_pipe_writer>);
+NEO_TEST_CONCEPT(neo::vectored_write_stream<neo::spsc_pipe_writer>);
+
+TEST_CASE("Read and write through an SPSC pipe") {
+    auto [in, out] = neo::make_spsc_pipe(6);
+    CHECK(out.capacity() == 8);
+    in.set_nonblocking(true);
+    out.set_nonblocking(true);
+
+    std::string buf;
+    buf.resize(8);
+    auto res = in.read_some(neo::mutable_buffer(buf));
+    CHECK(res.bytes_transferred == 0);
+    CHECK(neo::transfer_would_block(res));
+
+    res = out.write_some(neo::const_buffer("abcdef"));
+    CHECK(res.bytes_transferred == 6);
+    CHECK(in.available() == 6);
+    res = in.read_some(neo::mutable_buffer(buf));
+    CHECK(res.bytes_transferred == 6);
+    CHECK(buf.substr(0, 6) == "abcdef");
+
+    // Only two bytes remain before the end of the ring, so this wraps around.
+    // It is written from two buffers and read into two buffers.
+    std::array<neo::const_buffer, 2> src = {neo::const_buffer("0123"), neo::const_buffer("4567")};
+    res                                  = out.write_some(src);
+    CHECK(res.bytes_transferred == 8);
+    res = out.write_some(neo::const_buffer("more"));
+    CHECK(neo::transfer_would_block(res));
+
+    std::string                        first(3, '.');
+    std::string                        second(5, '.');
+    std::array<neo::mutable_buffer, 2> dest = {neo::mutable_buffer(first),
+                                               neo::mutable_buffer(second)};
+    res                                     = in.read_some(dest);
+    CHECK(res.bytes_transferred == 8);
+    CHECK(first == "012");
+    CHECK(second == "34567");
+}
+
+TEST_CASE("Close either end of an SPSC pipe") {
+    auto [in, out] = neo::make_spsc_pipe(16);
+    neo::write(out, neo::const_buffer("Hello"));
+    out.close();
+
+    std::string buf;
+    buf.resize(16);
+    auto res = neo::read(in, neo::mutable_buffer(buf));
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == 5);
+    // EOF
+    CHECK(in.read_some(neo::mutable_buffer(buf)).bytes_transferred == 0);
+
+    auto [in2, out2] = neo::make_spsc_pipe(16);
+    in2.close();
+    std::string more(32, 'x');
+    auto        wr = neo::write(out2, neo::const_buffer(more));
+    CHECK(wr.error() == std::errc::broken_pipe);
+}
+
+TEST_CASE("Hand data between threads through an SPSC pipe") {
+    auto [in, out] = neo::make_spsc_pipe(1024);
+
+    std::string data;
+    for (auto i = 0; data.size() < 1024 * 1024; ++i) {
+        data += std::to_string(i);
+    }
+
+    // The producer's results are checked after it is joined
+    std::error_code write_ec;
+    std::size_t     n_written = 0;
+    std::thread     producer{[&, &out = out] {
+        // Write in uneven pieces, so that writes often wrap around the ring
+        for (std::size_t size = 1; n_written < data.size(); size = size % 1500 + 7) {
+            auto part = neo::const_buffer(std::string_view(data).substr(n_written, size));
+            auto res  = neo::write(out, part);
+            n_written += res.bytes_transferred;
+            if (res.error()) {
+                write_ec = res.error();
+                break;
+            }
+        }
+        out.close();
+    }};
+
+    std::string got;
+    got.resize(data.size() + 1);
+    auto res = neo::read(in, neo::mutable_buffer(got));
+    producer.join();
+    CHECK_FALSE(write_ec);
+    CHECK(n_written == data.size());
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == data.size());
+    got.resize(res.bytes_transferred);
+    CHECK(got == data);
+}
@@ -17,6 +17,10 @@ void win32_handle_stream_base::close() noexcept {
     }
 }
 
+void win32_handle_stream_base::set_nonblocking(bool, std::error_code& ec) noexcept {
+    ec = make_error_code(std::errc::operation_not_supported);
+}
+
 native_read_result win32_handle_stream_base::read_some(mutable_buffer mbuf) noexcept {
     DWORD n_did_read = 0;
     auto  dw_size    = static_cast<DWORD>(mbuf.size());
@@ -41,6 +45,85 @@ native_write_result win32_handle_stream_base::write_some(const_buffer cbuf) noex
 
 namespace {
 
+OVERLAPPED overlapped_at(std::uint64_t offset) noexcept {
+    OVERLAPPED ov = {};
+    ov.Offset     = static_cast<DWORD>(offset & 0xffff'ffff);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    return ov;
+}
+
+/**
+ * A ReadFile() or WriteFile() at an OVERLAPPED offset still moves the file
+ * pointer of a synchronous handle. This puts the file pointer back where it was.
+ */
+class file_pointer_restorer {
+    HANDLE        _handle;
+    LARGE_INTEGER _pos   = {};
+    bool          _saved = false;
+
+public:
+    explicit file_pointer_restorer(HANDLE h) noexcept
+        : _handle(h) {
+        LARGE_INTEGER zero = {};
+        _saved             = ::SetFilePointerEx(h, zero, &_pos, FILE_CURRENT) != 0;
+    }
+
+    ~file_pointer_restorer() {
+        if (_saved) {
+            ::SetFilePointerEx(_handle, _pos, nullptr, FILE_BEGIN);
+        }
+    }
+};
+
+}  // namespace
+
+native_read_result win32_handle_stream_base::read_some_at(std::uint64_t  offset,
+                                                          mutable_buffer mbuf,
+                                                          rw_flags       flags) noexcept {
+    if (flags != rw_flags::none) {
+        // WSAEOPNOTSUPP is the Win32 error that compares equal to
+        // std::errc::operation_not_supported
+        return {{.bytes_transferred = 0, .errn = WSAEOPNOTSUPP}};
+    }
+    file_pointer_restorer restore{_native_handle};
+    DWORD                 n_did_read = 0;
+    auto                  dw_size    = static_cast<DWORD>(mbuf.size());
+    auto                  ov         = overlapped_at(offset);
+    ::SetLastError(0);
+    ::ReadFile(_native_handle, mbuf.data(), dw_size, &n_did_read, &ov);
+    auto err = ::GetLastError();
+    if (err == ERROR_HANDLE_EOF) {
+        // Reading beyond the end of the file is not an error for a stream
+        err = 0;
+    }
+    return {{
+        .bytes_transferred = static_cast<std::size_t>(n_did_read),
+        .errn              = static_cast<int>(err),
+    }};
+}
+
+native_write_result win32_handle_stream_base::write_some_at(std::uint64_t offset,
+                                                            const_buffer  cbuf,
+                                                            rw_flags      flags) noexcept {
+    if (flags != rw_flags::none) {
+        // WSAEOPNOTSUPP is the Win32 error that compares equal to
+        // std::errc::operation_not_supported
+        return {{.bytes_transferred = 0, .errn = WSAEOPNOTSUPP}};
+    }
+    file_pointer_restorer restore{_native_handle};
+    DWORD                 n_did_write = 0;
+    auto                  dw_size     = static_cast<DWORD>(cbuf.size());
+    auto                  ov          = overlapped_at(offset);
+    ::SetLastError(0);
+    ::WriteFile(_native_handle, cbuf.data(), dw_size, &n_did_write, &ov);
+    return {{
+        .bytes_transferred = static_cast<std::size_t>(n_did_write),
+        .errn              = static_cast<int>(::GetLastError()),
+    }};
+}
+
+namespace {
+
 struct nonown_handle_stream : neo::native_stream {
     ~nonown_handle_stream() { (void)this->release(); }
     nonown_handle_stream(native_handle_type hndl) { reset(std::move(hndl)); }
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <neo/io/stream/result.hpp>
+#include <neo/io/stream/rw_flags.hpp>
 
 #include <neo/const_buffer.hpp>
 #include <neo/mutable_buffer.hpp>
 
+#include <cstdint>
+#include <system_error>
+
 namespace neo {
 
 class win32_handle_stream_base {
@@ -29,8 +33,23 @@ protected:
 
     void close() noexcept;
 
+    /**
+     * Non-blocking mode is not supported for Win32 handles. Always fails.
+     */
+    void set_nonblocking(bool, std::error_code& ec) noexcept;
+
     native_stream_read_result  read_some(neo::mutable_buffer) noexcept;
     native_stream_write_result write_some(neo::const_buffer) noexcept;
+
+    /**
+     * Read and write at an offset using an OVERLAPPED offset. No rw_flags are
+     * supported on Windows. Windows moves the file pointer even for these
+     * operations, so it is put back afterward.
+     */
+    native_stream_read_result
+    read_some_at(std::uint64_t offset, neo::mutable_buffer, rw_flags = rw_flags::none) noexcept;
+    native_stream_write_result
+    write_some_at(std::uint64_t offset, neo::const_buffer, rw_flags = rw_flags::none) noexcept;
 };
 
 #if _WIN32
@@ -0,0 +1,174 @@
+#include "./zerocopy.hpp"
+
+#include <cstring>
+#include <new>
+
+#if __linux__
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+using namespace neo;
+
+zerocopy_sender::zerocopy_sender(socket& sock, options opts) noexcept
+    : _sock(sock)
+    , _opts(opts) {
+#if __linux__
+    int one  = 1;
+    _enabled = ::setsockopt(native_handle_of(_sock), SOL_SOCKET, SO_ZEROCOPY, &one, sizeof one)
+        == 0;
+#endif
+}
+
+void zerocopy_sender::_complete(std::uint32_t lo, std::uint32_t hi, bool copied) noexcept {
+    // IDs wrap around, so compare offsets from `lo`
+    const std::uint32_t span = hi - lo;
+    for (auto& p : _pending) {
+        if (!p.done && std::uint32_t(p.id - lo) <= span) {
+            p.done = true;
+            p.owner.reset();
+            --_n_pending;
+            if (copied) {
+                ++_n_copied;
+            }
+        }
+    }
+    while (!_pending.empty() && _pending.front().done) {
+        _pending.pop_front();
+    }
+}
+
+#if __linux__
+
+basic_transfer_result zerocopy_sender::_send(std::span<const const_buffer>      bufs,
+                                             const std::shared_ptr<const void>& owner) noexcept {
+    std::array<::iovec, max_send_buffers> iovs;
+    std::size_t                           total = 0;
+    for (std::size_t i = 0; i < bufs.size(); ++i) {
+        iovs[i] = {const_cast<std::byte*>(bufs[i].data()), bufs[i].size()};
+        total += bufs[i].size();
+    }
+    ::msghdr msg = {};
+    msg.msg_iov    = iovs.data();
+    msg.msg_iovlen = bufs.size();
+
+    const bool zerocopy = _enabled && total >= _opts.threshold;
+    if (zerocopy) {
+        // Reserve the slot before sending: once the kernel accepts the send, its completion must
+        // be tracked. The slot is marked done until the send succeeds.
+        try {
+            _pending.push_back({_next_id, true, nullptr});
+        } catch (const std::bad_alloc&) {
+            return {0, make_error_code(std::errc::not_enough_memory)};
+        }
+    }
+    auto rc = ::sendmsg(native_handle_of(_sock), &msg, zerocopy ? MSG_ZEROCOPY : 0);
+    if (rc >= 0 && zerocopy) {
+        // The kernel numbers each successful zero-copy send on the socket
+        auto& slot = _pending.back();
+        slot.done  = false;
+        slot.owner = owner;
+        ++_next_id;
+        ++_n_pending;
+        return {static_cast<std::size_t>(rc)};
+    }
+    const int err = errno;
+    if (zerocopy) {
+        _pending.pop_back();
+    }
+    if (rc < 0 && zerocopy && err == ENOBUFS) {
+        // Too much memory is pinned by pending sends. Copy this one instead.
+        rc = ::sendmsg(native_handle_of(_sock), &msg, 0);
+        if (rc < 0) {
+            return {0, std::error_code(errno, std::system_category())};
+        }
+        return {static_cast<std::size_t>(rc)};
+    }
+    if (rc < 0) {
+        return {0, std::error_code(err, std::system_category())};
+    }
+    return {static_cast<std::size_t>(rc)};
+}
+
+std::size_t zerocopy_sender::poll_completions(std::error_code& ec) noexcept {
+    const auto n_before = _n_pending;
+    while (_n_pending != 0) {
+        union {
+            ::cmsghdr align;
+            char      buf[CMSG_SPACE(sizeof(::sock_extended_err) + sizeof(::sockaddr_in6))];
+        } control;
+        ::msghdr msg       = {};
+        msg.msg_control    = control.buf;
+        msg.msg_controllen = sizeof control.buf;
+        auto rc            = ::recvmsg(native_handle_of(_sock), &msg, MSG_ERRQUEUE);
+        if (rc < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ec = std::error_code(errno, std::system_category());
+            }
+            break;
+        }
+        for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            const bool is_recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)
+                || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+            if (!is_recverr) {
+                continue;
+            }
+            ::sock_extended_err serr;
+            std::memcpy(&serr, CMSG_DATA(cm), sizeof serr);
+            if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr.ee_errno != 0) {
+                continue;
+            }
+            _complete(serr.ee_info, serr.ee_data, (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+        }
+    }
+    return n_before - _n_pending;
+}
+
+std::size_t zerocopy_sender::wait_completions(std::chrono::milliseconds timeout,
+                                              std::error_code&          ec) noexcept {
+    if (_n_pending == 0) {
+        return 0;
+    }
+    // The error queue is reported as POLLERR, which need not be requested
+    ::pollfd pfd = {};
+    pfd.fd       = native_handle_of(_sock);
+    auto rc      = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (rc < 0) {
+        ec = std::error_code(errno, std::system_category());
+        return 0;
+    }
+    return poll_completions(ec);
+}
+
+#else
+
+basic_transfer_result zerocopy_sender::_send(std::span<const const_buffer> bufs,
+                                             const std::shared_ptr<const void>&) noexcept {
+    auto res = _sock.write_some(bufs);
+    return {res.bytes_transferred, res.error()};
+}
+
+std::size_t zerocopy_sender::poll_completions(std::error_code&) noexcept { return 0; }
+
+std::size_t zerocopy_sender::wait_completions(std::chrono::milliseconds,
+                                              std::error_code&) noexcept {
+    return 0;
+}
+
+#endif
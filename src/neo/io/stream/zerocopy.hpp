@@ -0,0 +1,140 @@
+#pragma once
+
+#include <neo/io/stream/socket.hpp>
+
+#include <neo/buffer_range.hpp>
+#include <neo/const_buffer.hpp>
+
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <system_error>
+
+namespace neo {
+
+/**
+ * @brief Sends large writes on a stream socket without copying them into the
+ * kernel, using MSG_ZEROCOPY (Linux only).
+ *
+ * A zero-copy send returns as soon as the data is queued, but the kernel
+ * reads from the caller's buffers until the data is acknowledged by the peer.
+ * The kernel then reports a completion for the send on the socket's error
+ * queue. Until that completion, the buffers must not be modified or freed.
+ * To make this easy, write_some() accepts an `owner` that keeps the buffers
+ * alive, and that is released when the completion is processed by
+ * poll_completions() or wait_completions().
+ *
+ * Pinning pages and processing completions costs more than copying small
+ * writes, so writes smaller than `options::threshold` are sent normally.
+ * Zero-copy is also skipped (and every write copies) if the kernel or
+ * platform does not support it.
+ *
+ * A zerocopy_sender must be the only object that sends on the socket or
+ * reads its error queue, and must outlive all of its pending sends.
+ */
+class zerocopy_sender {
+public:
+    struct options {
+        /// Writes of fewer bytes than this are copied rather than sent with MSG_ZEROCOPY
+        std::size_t threshold = 32 * 1024;
+    };
+
+private:
+    struct pending_send {
+        std::uint32_t               id;
+        bool                        done = false;
+        std::shared_ptr<const void> owner;
+    };
+
+    socket&                  _sock;
+    options                  _opts;
+    bool                     _enabled = false;
+    std::uint32_t            _next_id = 0;
+    std::deque<pending_send> _pending;
+    std::size_t              _n_pending = 0;
+    std::uint64_t            _n_copied  = 0;
+
+    constexpr static std::size_t max_send_buffers = 64;
+
+    basic_transfer_result _send(std::span<const const_buffer>      bufs,
+                                const std::shared_ptr<const void>& owner) noexcept;
+    void                  _complete(std::uint32_t lo, std::uint32_t hi, bool copied) noexcept;
+
+public:
+    /**
+     * @brief Prepare to send on the given socket, and enable SO_ZEROCOPY on it
+     * if possible.
+     */
+    zerocopy_sender(socket& sock, options opts) noexcept;
+    explicit zerocopy_sender(socket& sock) noexcept
+        : zerocopy_sender(sock, options{}) {}
+
+    zerocopy_sender(const zerocopy_sender&) = delete;
+    zerocopy_sender& operator=(const zerocopy_sender&) = delete;
+
+    /// Whether large writes are sent with MSG_ZEROCOPY
+    bool enabled() const noexcept { return _enabled; }
+
+    /**
+     * @brief Write some data from the buffers to the socket.
+     *
+     * If this is a zero-copy send, `owner` is held until its completion. If no
+     * owner is given, the caller must otherwise keep the buffers unmodified
+     * until pending_count() drops to zero.
+     */
+    template <buffer_range Bufs>
+    basic_transfer_result write_some(Bufs&&                      bufs,
+                                     std::shared_ptr<const void> owner = nullptr) noexcept {
+        std::array<const_buffer, max_send_buffers> arr;
+        std::size_t                                n_bufs = 0;
+        if constexpr (std::convertible_to<Bufs, const_buffer>) {
+            arr[n_bufs++] = const_buffer(bufs);
+        } else {
+            for (const_buffer b : bufs) {
+                if (n_bufs == arr.size()) {
+                    break;
+                }
+                if (b.size() != 0) {
+                    arr[n_bufs++] = b;
+                }
+            }
+        }
+        return _send(std::span(arr.data(), n_bufs), owner);
+    }
+
+    /**
+     * @brief Process the completions that the kernel has reported, without
+     * waiting, and release the owners of the completed sends.
+     *
+     * @return The number of sends that completed.
+     */
+    std::size_t poll_completions(std::error_code& ec) noexcept;
+    std::size_t poll_completions() {
+        return poll_completions("Failed to read zero-copy send completions"_ec_throw);
+    }
+
+    /**
+     * @brief Wait up to `timeout` for at least one completion (if any sends
+     * are pending), then process all completions as with poll_completions().
+     */
+    std::size_t wait_completions(std::chrono::milliseconds timeout, std::error_code& ec) noexcept;
+    std::size_t wait_completions(std::chrono::milliseconds timeout) {
+        return wait_completions(timeout, "Failed to wait for zero-copy send completions"_ec_throw);
+    }
+
+    /// The number of zero-copy sends that have not yet completed
+    std::size_t pending_count() const noexcept { return _n_pending; }
+
+    /**
+     * @brief The number of zero-copy sends for which the kernel copied the data
+     * anyway (e.g. over loopback, or when the network card cannot send from
+     * user pages). If this is most sends, zero-copy is not worthwhile.
+     */
+    std::uint64_t copied_count() const noexcept { return _n_copied; }
+};
+
+}  // namespace neo
@@ -0,0 +1,78 @@
+#include <neo/io/stream/zerocopy.hpp>
+
+#include "../../../../testing/socket_pair.hpp"
+
+#include <neo/io/read.hpp>
+#include <neo/io/stream/listener.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+using neo::testing::make_socket_pair;
+
+TEST_CASE("Send a large buffer with zerocopy_sender") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto [client, server] = make_socket_pair(lis);
+    neo::zerocopy_sender zc{client};
+
+    auto payload = std::make_shared<std::string>();
+    for (auto i = 0; payload->size() < 1024 * 1024; ++i) {
+        *payload += "zero-copy chunk #" + std::to_string(i) + "\n";
+    }
+    std::weak_ptr<const void> weak_owner = payload;
+
+    std::string received(payload->size(), '\0');
+    std::thread reader{[&] { neo::read(server, neo::mutable_buffer(received)); }};
+
+    std::size_t n_written = 0;
+    std::size_t n_sends   = 0;
+    while (n_written < payload->size()) {
+        auto res = zc.write_some(neo::const_buffer(std::string_view(*payload).substr(n_written)),
+                                 payload);
+        REQUIRE_FALSE(res.error());
+        n_written += res.bytes_transferred;
+        ++n_sends;
+    }
+    reader.join();
+    CHECK(received == *payload);
+
+    // The pending sends hold the payload alive until they complete
+    payload.reset();
+    for (auto i = 0; zc.pending_count() != 0 && i < 100; ++i) {
+        zc.wait_completions(100ms);
+    }
+    CHECK(zc.pending_count() == 0);
+    CHECK(weak_owner.expired());
+    CHECK(zc.copied_count() <= n_sends);
+}
+
+TEST_CASE("Small writes are not sent with MSG_ZEROCOPY") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto [client, server] = make_socket_pair(lis);
+    neo::zerocopy_sender zc{client, {.threshold = 1024}};
+
+    auto res = zc.write_some(neo::const_buffer("Hello, zero-copy"));
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == 16);
+    CHECK(zc.pending_count() == 0);
+
+    std::string buf(16, '\0');
+    neo::read(server, neo::mutable_buffer(buf));
+    CHECK(buf == "Hello, zero-copy");
+
+    std::string big(4096, 'x');
+    res = zc.write_some(neo::const_buffer(big));
+    CHECK_FALSE(res.error());
+    CHECK(zc.pending_count() == (zc.enabled() ? 1 : 0));
+    std::string big_in(res.bytes_transferred, '\0');
+    neo::read(server, neo::mutable_buffer(big_in));
+    CHECK(big_in == big.substr(0, big_in.size()));
+    for (auto i = 0; zc.pending_count() != 0 && i < 100; ++i) {
+        zc.wait_completions(100ms);
+    }
+    CHECK(zc.pending_count() == 0);
+}
@@ -0,0 +1,272 @@
+#include "./transfer.hpp"
+
+#include <neo/platform.hpp>
+
+#if NEO_OS_IS_UNIX_LIKE
+#include <unistd.h>
+#endif
+
+#if __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#endif
+
+#include <cerrno>
+
+using namespace neo;
+
+namespace {
+
+native_transfer_result to_native_result(const basic_transfer_result& r) noexcept {
+    return {r.bytes_transferred, r.ec.value()};
+}
+
+/**
+ * Copy from a file at the given offset using read_some_at() (pread() or a
+ * ReadFile() at an OVERLAPPED offset), without touching the file position.
+ */
+native_transfer_result
+read_at_transfer(file_stream& in, neo::socket& out, std::uint64_t offset, std::size_t len) noexcept {
+    std::array<std::byte, 1024 * 16> buf;
+    native_transfer_result           ret;
+    while (ret.bytes_transferred < len) {
+        auto want   = (std::min)(buf.size(), len - ret.bytes_transferred);
+        auto read_r = in.read_some_at(offset + ret.bytes_transferred,
+                                      mutable_buffer(buf.data(), want));
+        if (read_r.has_error()) {
+            if (read_r.errn == EINTR) {
+                continue;
+            }
+            ret.errn = read_r.errn;
+            break;
+        }
+        if (read_r.bytes_transferred == 0) {
+            break;
+        }
+        auto write_r = neo::write(out, const_buffer(buf.data(), read_r.bytes_transferred));
+        ret.bytes_transferred += write_r.bytes_transferred;
+        if (write_r.has_error()) {
+            ret.errn = write_r.errn;
+            break;
+        }
+    }
+    return ret;
+}
+
+#if __linux__
+
+/// The largest transfer that Linux will perform in a single sendfile() or splice()
+constexpr std::size_t max_chunk_size = 0x7ffff000;
+
+/// The amount of data that we move through our intermediate pipe at a time
+constexpr std::size_t pipe_chunk_size = 1024 * 64;
+
+constexpr unsigned splice_flags = SPLICE_F_MOVE | SPLICE_F_MORE;
+
+bool is_pipe(int fd) noexcept {
+    struct ::stat st;
+    return ::fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode);
+}
+
+/// Whether an error from sendfile()/splice() indicates that the fds do not support the operation
+bool is_unsupported(int err) noexcept { return err == EINVAL || err == ENOSYS; }
+
+bool wait_writable(int fd) noexcept {
+    ::pollfd pfd = {};
+    pfd.fd       = fd;
+    pfd.events   = POLLOUT;
+    return ::poll(&pfd, 1, -1) >= 0 || errno == EINTR;
+}
+
+/**
+ * A pipe used as the intermediate buffer when splicing between two streams that are not pipes.
+ * Each thread keeps one open to avoid the pipe2() and close() calls on every transfer.
+ */
+struct splice_pipe {
+    native_stream read_end;
+    native_stream write_end;
+
+    bool open(std::error_code& ec) noexcept {
+        if (read_end.native_handle() != native_stream::invalid_native_handle_value) {
+            return true;
+        }
+        int fds[2] = {};
+        if (::pipe2(fds, O_CLOEXEC) == -1) {
+            ec = std::error_code(errno, std::system_category());
+            return false;
+        }
+        read_end.reset(std::move(fds[0]));
+        write_end.reset(std::move(fds[1]));
+        return true;
+    }
+
+    /// Throw away the pipe, including any data that is still within it
+    void discard() noexcept {
+        read_end.close();
+        write_end.close();
+    }
+};
+
+thread_local splice_pipe tl_splice_pipe;
+
+/**
+ * Write `n` bytes that are buffered in `pipe` into `out`.
+ *
+ * Returns false if we failed, in which case `ret.errn` is set.
+ */
+bool drain_pipe(splice_pipe& pipe, native_stream& out, std::size_t n, native_transfer_result& ret) {
+    bool use_splice = true;
+    while (n != 0) {
+        if (!use_splice) {
+            // The destination does not support splice(). Bounce the data through userspace.
+            auto r = neo::transfer<native_stream, native_stream>(pipe.read_end, out, n);
+            ret.bytes_transferred += r.bytes_transferred;
+            if (r.ec) {
+                ret.errn = r.ec.value();
+                return false;
+            }
+            return true;
+        }
+        auto n_out
+            = ::splice(pipe.read_end.native_handle(), nullptr, out.native_handle(), nullptr, n, 0);
+        if (n_out < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN && wait_writable(out.native_handle())) {
+                continue;
+            }
+            if (is_unsupported(errno)) {
+                use_splice = false;
+                continue;
+            }
+            ret.errn = errno;
+            return false;
+        }
+        n -= static_cast<std::size_t>(n_out);
+        ret.bytes_transferred += static_cast<std::size_t>(n_out);
+    }
+    return true;
+}
+
+native_transfer_result splice_via_pipe(native_stream& in, native_stream& out, std::size_t len) {
+    native_transfer_result ret;
+    auto&                  pipe = tl_splice_pipe;
+    std::error_code        ec;
+    if (!pipe.open(ec)) {
+        return {0, ec.value()};
+    }
+    while (ret.bytes_transferred < len) {
+        auto want = (std::min)(pipe_chunk_size, len - ret.bytes_transferred);
+        auto n_in = ::splice(in.native_handle(),
+                             nullptr,
+                             pipe.write_end.native_handle(),
+                             nullptr,
+                             want,
+                             splice_flags);
+        if (n_in < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (is_unsupported(errno) && ret.bytes_transferred == 0) {
+                return to_native_result(neo::transfer<native_stream, native_stream>(in, out, len));
+            }
+            ret.errn = errno;
+            break;
+        }
+        if (n_in == 0) {
+            break;
+        }
+        if (!drain_pipe(pipe, out, static_cast<std::size_t>(n_in), ret)) {
+            // The pipe may still hold data that was destined for `out`.
+            pipe.discard();
+            break;
+        }
+    }
+    return ret;
+}
+
+native_transfer_result splice_direct(native_stream& in, native_stream& out, std::size_t len) {
+    native_transfer_result ret;
+    while (ret.bytes_transferred < len) {
+        auto want = (std::min)(max_chunk_size, len - ret.bytes_transferred);
+        auto n    = ::splice(in.native_handle(),
+                          nullptr,
+                          out.native_handle(),
+                          nullptr,
+                          want,
+                          splice_flags);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (is_unsupported(errno) && ret.bytes_transferred == 0) {
+                return to_native_result(neo::transfer<native_stream, native_stream>(in, out, len));
+            }
+            ret.errn = errno;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        ret.bytes_transferred += static_cast<std::size_t>(n);
+    }
+    return ret;
+}
+
+#endif
+
+}  // namespace
+
+native_transfer_result
+neo::transfer(file_stream& in, neo::socket& out, std::uint64_t offset, std::size_t len) noexcept {
+#if __linux__
+    auto                   in_fd  = in.native().native_handle();
+    auto                   out_fd = out.native().native_handle();
+    auto                   off    = static_cast<::off_t>(offset);
+    native_transfer_result ret;
+    while (ret.bytes_transferred < len) {
+        auto want = (std::min)(max_chunk_size, len - ret.bytes_transferred);
+        auto n    = ::sendfile(out_fd, in_fd, &off, want);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (is_unsupported(errno) && ret.bytes_transferred == 0) {
+                return read_at_transfer(in, out, offset, len);
+            }
+            ret.errn = errno;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        ret.bytes_transferred += static_cast<std::size_t>(n);
+    }
+    return ret;
+#else
+    return read_at_transfer(in, out, offset, len);
+#endif
+}
+
+native_transfer_result
+neo::transfer(native_stream& in, native_stream& out, std::size_t len) noexcept {
+#if __linux__
+    if (is_pipe(in.native_handle()) || is_pipe(out.native_handle())) {
+        return splice_direct(in, out, len);
+    }
+    return splice_via_pipe(in, out, len);
+#else
+    return to_native_result(neo::transfer<native_stream, native_stream>(in, out, len));
+#endif
+}
+
+native_transfer_result neo::transfer(neo::socket& in, neo::socket& out, std::size_t len) noexcept {
+#if NEO_OS_IS_WINDOWS
+    return to_native_result(neo::transfer<neo::socket, neo::socket>(in, out, len));
+#else
+    return neo::transfer(in.native(), out.native(), len);
+#endif
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <neo/io/concepts/read_stream.hpp>
+#include <neo/io/concepts/write_stream.hpp>
+#include <neo/io/stream/file.hpp>
+#include <neo/io/stream/socket.hpp>
+#include <neo/io/write.hpp>
+
+#include <neo/const_buffer.hpp>
+#include <neo/mutable_buffer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace neo {
+
+/**
+ * @brief Transfer up to `len` bytes from `in` to `out`, copying the data
+ * through a buffer in userspace.
+ *
+ * This works on any pair of streams. It stops early when `in` reaches EOF, or
+ * when either stream reports an error. The returned `bytes_transferred` is the
+ * number of bytes that were written to `out`.
+ */
+template <read_stream In, write_stream Out>
+basic_transfer_result transfer(In& in, Out& out, std::size_t len) noexcept {
+    std::array<std::byte, 1024 * 16> buf;
+    basic_transfer_result            ret;
+    while (ret.bytes_transferred < len) {
+        auto want   = (std::min)(buf.size(), len - ret.bytes_transferred);
+        auto read_r = in.read_some(mutable_buffer(buf.data(), want));
+        if (read_r.bytes_transferred != 0) {
+            auto write_r = neo::write(out, const_buffer(buf.data(), read_r.bytes_transferred));
+            ret.bytes_transferred += write_r.bytes_transferred;
+            if (transfer_errant(write_r)) {
+                ret.ec = write_r.error();
+                break;
+            }
+        }
+        if (transfer_errant(read_r)) {
+            ret.ec = read_r.error();
+            break;
+        }
+        if (read_r.bytes_transferred == 0) {
+            // EOF
+            break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Transfer up to `len` bytes of the file `in`, beginning at `offset`,
+ * into the socket `out`.
+ *
+ * On Linux this uses sendfile(), and the data never passes through userspace.
+ * Otherwise (or if the file does not support sendfile()) the data is copied
+ * with positional reads (file_stream::read_some_at()) and write().
+ *
+ * The file position of `in` is not used, and is not modified. The transfer
+ * stops early if the end of the file is reached. If `out` is in non-blocking
+ * mode, the transfer may stop with a `would_block()` result.
+ */
+native_transfer_result
+transfer(file_stream& in, socket& out, std::uint64_t offset, std::size_t len) noexcept;
+
+/**
+ * @brief Transfer up to `len` bytes from `in` to `out`.
+ *
+ * On Linux this uses splice(). If neither stream is a pipe, the data is moved
+ * through an internal per-thread pipe, and never passes through userspace. If
+ * the streams do not support splice(), or on other platforms, the data is
+ * copied through userspace as with the generic transfer().
+ *
+ * The transfer stops early when `in` reaches EOF. If `in` is in non-blocking
+ * mode, the transfer may stop with a `would_block()` result. Data that has
+ * been read from `in` is always written to `out`, waiting for `out` to become
+ * writable if necessary.
+ */
+native_transfer_result transfer(native_stream& in, native_stream& out, std::size_t len) noexcept;
+
+/**
+ * @brief Transfer up to `len` bytes from one socket to another. Equivalent to
+ * the native_stream transfer() on the sockets' native streams.
+ */
+native_transfer_result transfer(socket& in, socket& out, std::size_t len) noexcept;
+
+}  // namespace neo
@@ -0,0 +1,96 @@
+#include <neo/io/transfer.hpp>
+
+#include "../../../testing/socket_pair.hpp"
+
+#include <neo/io/read.hpp>
+#include <neo/io/stream/listener.hpp>
+#include <neo/io/stream/string.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+namespace {
+
+using neo::testing::make_socket_pair;
+
+std::string read_n(neo::socket& s, std::size_t n) {
+    std::string ret;
+    ret.resize(n);
+    auto res = neo::read(s, neo::mutable_buffer(ret));
+    CHECK_FALSE(res.error());
+    ret.resize(res.bytes_transferred);
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Transfer between generic streams") {
+    neo::string_stream in{std::string("Hello, transfer!")};
+    neo::string_stream out;
+    auto               res = neo::transfer(in, out, 5);
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == 5);
+    CHECK(out.string == "Hello");
+
+    // Stops at EOF
+    res = neo::transfer(in, out, 1000);
+    CHECK_FALSE(res.error());
+    CHECK(res.bytes_transferred == 11);
+    CHECK(out.string == "Hello, transfer!");
+}
+
+TEST_CASE("Transfer a file into a socket") {
+    std::string content;
+    for (auto i = 0; i < 10000; ++i) {
+        content += std::to_string(i) + ",";
+    }
+    {
+        neo::file_stream file("transfer-test.txt", neo::open_mode::write);
+        REQUIRE_FALSE(neo::write(file, neo::const_buffer(content)).error());
+    }
+
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto [client, server] = make_socket_pair(lis);
+
+    auto file = neo::file_stream::open("transfer-test.txt");
+    auto res  = neo::transfer(file, server, 6, 1000);
+    CHECK_FALSE(res.has_error());
+    CHECK(res.bytes_transferred == 1000);
+    CHECK(read_n(client, 1000) == content.substr(6, 1000));
+
+    // Transferring past the end of the file stops at EOF
+    res = neo::transfer(file, server, content.size() - 10, 1000);
+    CHECK_FALSE(res.has_error());
+    CHECK(res.bytes_transferred == 10);
+    CHECK(read_n(client, 10) == content.substr(content.size() - 10));
+
+    // The file position is untouched
+    std::string head;
+    head.resize(4);
+    REQUIRE_FALSE(neo::read(file, neo::mutable_buffer(head)).error());
+    CHECK(head == content.substr(0, 4));
+}
+
+TEST_CASE("Transfer between sockets") {
+    neo::listener lis{neo::address::resolve("127.0.0.1", "0")};
+    auto [a_client, a_server] = make_socket_pair(lis);
+    auto [b_client, b_server] = make_socket_pair(lis);
+
+    std::string payload(1024 * 200, 'x');
+    for (auto i = 0u; i < payload.size(); i += 7) {
+        payload[i] = 'y';
+    }
+
+    // Writing 200k would fill the socket buffers, so push it in pieces
+    std::string got;
+    for (auto pos = 0u; pos < payload.size(); pos += 1024 * 20) {
+        auto part = payload.substr(pos, 1024 * 20);
+        REQUIRE_FALSE(neo::write(a_client, neo::const_buffer(part)).error());
+        auto res = neo::transfer(a_server, b_client, part.size());
+        CHECK_FALSE(res.has_error());
+        CHECK(res.bytes_transferred == part.size());
+        got += read_n(b_server, part.size());
+    }
+    CHECK(got == payload);
+}
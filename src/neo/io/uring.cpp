@@ -0,0 +1,522 @@
+#include "./uring.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#if !_WIN32
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if __linux__ && __has_include(<linux/io_uring.h>)
+#define NEO_IO_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+
+#ifndef IORING_FEAT_RW_CUR_POS
+#define IORING_FEAT_RW_CUR_POS (1U << 3)
+#endif
+#else
+#define NEO_IO_HAVE_IO_URING 0
+#endif
+
+using namespace neo;
+
+#if NEO_IO_HAVE_IO_URING
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, ::io_uring_params* p) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+unsigned load_acquire(const unsigned* p) noexcept {
+    return std::atomic_ref<const unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned* p, unsigned v) noexcept {
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+}  // namespace
+
+/**
+ * The memory-mapped submission and completion queues of an io_uring instance.
+ */
+struct io_detail::uring_ring {
+    native_stream ring_fd;
+
+    void*       sq_map   = MAP_FAILED;
+    std::size_t sq_size  = 0;
+    void*       cq_map   = MAP_FAILED;
+    std::size_t cq_size  = 0;
+    void*       sqe_map  = MAP_FAILED;
+    std::size_t sqe_size = 0;
+
+    unsigned* sq_head    = nullptr;
+    unsigned* sq_tail    = nullptr;
+    unsigned  sq_mask    = 0;
+    unsigned  sq_entries = 0;
+    unsigned* sq_array   = nullptr;
+
+    ::io_uring_sqe* sqes = nullptr;
+
+    unsigned*       cq_head = nullptr;
+    unsigned*       cq_tail = nullptr;
+    unsigned        cq_mask = 0;
+    ::io_uring_cqe* cqes    = nullptr;
+
+    /// Number of SQEs that have been filled but not yet passed to io_uring_enter()
+    unsigned n_unsubmitted = 0;
+
+    uring_ring()                  = default;
+    uring_ring(const uring_ring&) = delete;
+
+    ~uring_ring() {
+        if (sqe_map != MAP_FAILED) {
+            ::munmap(sqe_map, sqe_size);
+        }
+        if (cq_map != MAP_FAILED && cq_map != sq_map) {
+            ::munmap(cq_map, cq_size);
+        }
+        if (sq_map != MAP_FAILED) {
+            ::munmap(sq_map, sq_size);
+        }
+    }
+
+    /**
+     * Attempt to create an io_uring. Returns nullptr if io_uring is unavailable.
+     */
+    static std::unique_ptr<uring_ring> create(unsigned entries) {
+        ::io_uring_params params = {};
+
+        auto fd = sys_io_uring_setup(entries, &params);
+        if (fd < 0) {
+            // ENOSYS (old kernel), EPERM (disabled by policy or seccomp), etc.
+            return nullptr;
+        }
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            // Before Linux 5.6, an offset of -1 does not mean "the current file
+            // position", and reads and writes on files would fail with EINVAL.
+            ::close(fd);
+            return nullptr;
+        }
+
+        auto ring     = std::make_unique<uring_ring>();
+        ring->ring_fd = native_stream::from_native_handle(std::move(fd));
+
+        ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            ring->sq_size = ring->cq_size = (std::max)(ring->sq_size, ring->cq_size);
+        }
+
+        auto rfd     = ring->ring_fd.native_handle();
+        ring->sq_map = ::mmap(nullptr,
+                              ring->sq_size,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE,
+                              rfd,
+                              IORING_OFF_SQ_RING);
+        if (ring->sq_map == MAP_FAILED) {
+            return nullptr;
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            ring->cq_map = ring->sq_map;
+        } else {
+            ring->cq_map = ::mmap(nullptr,
+                                  ring->cq_size,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE,
+                                  rfd,
+                                  IORING_OFF_CQ_RING);
+            if (ring->cq_map == MAP_FAILED) {
+                return nullptr;
+            }
+        }
+        ring->sqe_size = params.sq_entries * sizeof(::io_uring_sqe);
+        ring->sqe_map  = ::mmap(nullptr,
+                               ring->sqe_size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE,
+                               rfd,
+                               IORING_OFF_SQES);
+        if (ring->sqe_map == MAP_FAILED) {
+            return nullptr;
+        }
+
+        auto sq_base     = static_cast<std::byte*>(ring->sq_map);
+        ring->sq_head    = reinterpret_cast<unsigned*>(sq_base + params.sq_off.head);
+        ring->sq_tail    = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+        ring->sq_mask    = *reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+        ring->sq_entries = params.sq_entries;
+        ring->sq_array   = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+        ring->sqes       = static_cast<::io_uring_sqe*>(ring->sqe_map);
+
+        auto cq_base  = static_cast<std::byte*>(ring->cq_map);
+        ring->cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+        ring->cq_mask = *reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+        ring->cqes    = reinterpret_cast<::io_uring_cqe*>(cq_base + params.cq_off.cqes);
+        return ring;
+    }
+
+    /**
+     * Obtain the next free submission queue entry, or nullptr if the queue is full.
+     */
+    ::io_uring_sqe* next_sqe() noexcept {
+        auto head = load_acquire(sq_head);
+        auto tail = *sq_tail + n_unsubmitted;
+        if (tail - head >= sq_entries) {
+            return nullptr;
+        }
+        auto idx      = tail & sq_mask;
+        sq_array[idx] = idx;
+        ++n_unsubmitted;
+        auto sqe = &sqes[idx];
+        *sqe     = {};
+        return sqe;
+    }
+
+    /**
+     * Publish the filled SQEs and enter the kernel.
+     */
+    int enter(unsigned min_complete) noexcept {
+        auto to_submit = n_unsubmitted;
+        if (to_submit) {
+            store_release(sq_tail, *sq_tail + to_submit);
+            n_unsubmitted = 0;
+        }
+        if (to_submit == 0 && min_complete == 0) {
+            return 0;
+        }
+        int rc;
+        do {
+            rc = sys_io_uring_enter(ring_fd.native_handle(),
+                                    to_submit,
+                                    min_complete,
+                                    min_complete ? IORING_ENTER_GETEVENTS : 0u);
+        } while (rc < 0 && errno == EINTR && to_submit == 0);
+        return rc < 0 ? errno : 0;
+    }
+
+    /**
+     * Pop completion queue entries into `out`. Returns the number popped.
+     */
+    template <typename Func>
+    std::size_t drain(std::size_t max, Func&& on_cqe) noexcept {
+        auto        head = *cq_head;
+        auto        tail = load_acquire(cq_tail);
+        std::size_t n    = 0;
+        for (; head != tail && n < max; ++head, ++n) {
+            on_cqe(cqes[head & cq_mask]);
+        }
+        store_release(cq_head, head);
+        return n;
+    }
+};
+
+#else
+
+struct io_detail::uring_ring {};
+
+#endif
+
+uring_engine::uring_engine(unsigned queue_depth, uring_mode mode)
+    : _slots(queue_depth) {
+    neo_assert(expects, queue_depth > 0, "uring_engine requires a non-zero queue depth");
+    for (auto& slot : _slots) {
+        slot.next_free = std::exchange(_free_slots, &slot);
+    }
+    _pending.reserve(queue_depth);
+    _fallback_done.reserve(queue_depth);
+#if NEO_IO_HAVE_IO_URING
+    if (mode == uring_mode::automatic) {
+        _ring = io_detail::uring_ring::create(queue_depth);
+    }
+#else
+    (void)mode;
+#endif
+}
+
+uring_engine::~uring_engine() = default;
+uring_engine::uring_engine(uring_engine&&) noexcept = default;
+uring_engine& uring_engine::operator=(uring_engine&&) noexcept = default;
+
+uring_engine::op_slot*
+uring_engine::_new_op(op_kind kind, native_stream_handle hndl, std::uint64_t user_data) noexcept {
+    if (!_free_slots) {
+        return nullptr;
+    }
+    auto slot       = std::exchange(_free_slots, _free_slots->next_free);
+    slot->kind      = kind;
+    slot->handle    = hndl;
+    slot->user_data = user_data;
+    slot->buf_index = 0;
+    slot->iov.clear();
+    return slot;
+}
+
+void uring_engine::_release_op(op_slot& slot) noexcept {
+    slot.next_free = std::exchange(_free_slots, &slot);
+}
+
+bool uring_engine::_prep_fixed(op_kind              kind,
+                               native_stream_handle hndl,
+                               std::size_t          buf_index,
+                               const_buffer         part,
+                               std::uint64_t        user_data) {
+    neo_assert(expects,
+               buf_index < _registered_buffers.size(),
+               "Fixed-buffer operation refers to an unregistered buffer",
+               buf_index,
+               _registered_buffers.size());
+    auto& reg       = _registered_buffers[buf_index];
+    auto  reg_begin = static_cast<const std::byte*>(reg.iov_base);
+    neo_assert(expects,
+               part.data() >= reg_begin && part.data() + part.size() <= reg_begin + reg.iov_len,
+               "Fixed-buffer operation must lie within the registered buffer",
+               buf_index,
+               part.size(),
+               reg.iov_len);
+
+    auto slot = _new_op(kind, hndl, user_data);
+    if (!slot) {
+        return false;
+    }
+    slot->buf_index = static_cast<std::uint16_t>(buf_index);
+    try {
+        _push_iov(*slot, part);
+        _pending.push_back(slot);
+    } catch (...) {
+        _release_op(*slot);
+        throw;
+    }
+    return true;
+}
+
+void uring_engine::register_buffers(std::span<const mutable_buffer> bufs, std::error_code& ec) {
+    neo_assert(expects,
+               _pending.empty() && _n_in_flight == 0,
+               "Cannot change uring_engine buffer registrations while operations are outstanding",
+               _pending.size(),
+               _n_in_flight);
+    std::vector<posix_iovec_type> iovs;
+    iovs.reserve(bufs.size());
+    for (auto buf : bufs) {
+        iovs.push_back({buf.data(), buf.size()});
+    }
+#if NEO_IO_HAVE_IO_URING
+    if (_ring) {
+        auto rfd = _ring->ring_fd.native_handle();
+        if (!_registered_buffers.empty()) {
+            sys_io_uring_register(rfd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        }
+        if (!iovs.empty()
+            && sys_io_uring_register(rfd,
+                                     IORING_REGISTER_BUFFERS,
+                                     iovs.data(),
+                                     static_cast<unsigned>(iovs.size()))
+                < 0) {
+            ec = std::error_code(errno, std::system_category());
+            _registered_buffers.clear();
+            return;
+        }
+    }
+#endif
+    _registered_buffers = std::move(iovs);
+}
+
+void uring_engine::register_handles(std::span<const native_stream_handle> handles,
+                                    std::error_code&                      ec) {
+    neo_assert(expects,
+               _pending.empty() && _n_in_flight == 0,
+               "Cannot change uring_engine handle registrations while operations are outstanding",
+               _pending.size(),
+               _n_in_flight);
+    std::unordered_map<native_stream_handle, unsigned> new_map;
+    unsigned                                           idx = 0;
+    for (auto h : handles) {
+        new_map.emplace(h, idx++);
+    }
+#if NEO_IO_HAVE_IO_URING
+    if (_ring) {
+        auto rfd = _ring->ring_fd.native_handle();
+        if (!_registered_handles.empty()) {
+            sys_io_uring_register(rfd, IORING_UNREGISTER_FILES, nullptr, 0);
+        }
+        std::vector<int> fds(handles.begin(), handles.end());
+        if (!fds.empty()
+            && sys_io_uring_register(rfd,
+                                     IORING_REGISTER_FILES,
+                                     fds.data(),
+                                     static_cast<unsigned>(fds.size()))
+                < 0) {
+            ec = std::error_code(errno, std::system_category());
+            _registered_handles.clear();
+            return;
+        }
+    }
+#endif
+    _registered_handles = std::move(new_map);
+}
+
+void uring_engine::_submit_fallback() noexcept {
+#if !_WIN32
+    for (auto slot : _pending) {
+        auto    iov = reinterpret_cast<const ::iovec*>(slot->iov.data());
+        auto    n   = static_cast<int>(slot->iov.size());
+        ssize_t rc  = 0;
+        switch (slot->kind) {
+        case op_kind::readv:
+        case op_kind::read_fixed:
+            rc = ::readv(slot->handle, iov, n);
+            break;
+        case op_kind::writev:
+        case op_kind::write_fixed:
+            rc = ::writev(slot->handle, iov, n);
+            break;
+        }
+        native_transfer_result res;
+        if (rc < 0) {
+            res.errn = errno;
+        } else {
+            res.bytes_transferred = static_cast<std::size_t>(rc);
+        }
+        // Capacity was reserved for every slot, so this will not allocate
+        _fallback_done.push_back({slot->user_data, res});
+        _release_op(*slot);
+    }
+#else
+    for (auto slot : _pending) {
+        native_transfer_result res;
+        res.errn = static_cast<int>(std::errc::function_not_supported);
+        _fallback_done.push_back({slot->user_data, res});
+        _release_op(*slot);
+    }
+#endif
+    _n_in_flight += _pending.size();
+    _pending.clear();
+}
+
+std::size_t uring_engine::submit(std::error_code& ec) noexcept {
+    auto n_submit = _pending.size();
+    if (!_ring) {
+        _submit_fallback();
+        return n_submit;
+    }
+#if NEO_IO_HAVE_IO_URING
+    std::size_t n_prepped = 0;
+    for (auto slot : _pending) {
+        auto sqe = _ring->next_sqe();
+        if (!sqe) {
+            // The ring is full. Submit what we have and try again.
+            if (auto err = _ring->enter(0)) {
+                ec = std::error_code(err, std::system_category());
+                break;
+            }
+            sqe = _ring->next_sqe();
+            if (!sqe) {
+                break;
+            }
+        }
+        switch (slot->kind) {
+        case op_kind::readv:
+            sqe->opcode = IORING_OP_READV;
+            break;
+        case op_kind::writev:
+            sqe->opcode = IORING_OP_WRITEV;
+            break;
+        case op_kind::read_fixed:
+            sqe->opcode = IORING_OP_READ_FIXED;
+            break;
+        case op_kind::write_fixed:
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            break;
+        }
+        if (slot->kind == op_kind::read_fixed || slot->kind == op_kind::write_fixed) {
+            sqe->addr      = reinterpret_cast<std::uintptr_t>(slot->iov.front().iov_base);
+            sqe->len       = static_cast<std::uint32_t>(slot->iov.front().iov_len);
+            sqe->buf_index = slot->buf_index;
+        } else {
+            sqe->addr = reinterpret_cast<std::uintptr_t>(slot->iov.data());
+            sqe->len  = static_cast<std::uint32_t>(slot->iov.size());
+        }
+        // Use (and advance) the current file position, like read()/write()
+        sqe->off       = ~std::uint64_t(0);
+        sqe->user_data = reinterpret_cast<std::uintptr_t>(slot);
+
+        auto fixed = _registered_handles.find(slot->handle);
+        if (fixed != _registered_handles.end()) {
+            sqe->fd = static_cast<int>(fixed->second);
+            sqe->flags |= IOSQE_FIXED_FILE;
+        } else {
+            sqe->fd = slot->handle;
+        }
+        ++n_prepped;
+    }
+    if (!ec) {
+        if (auto err = _ring->enter(0)) {
+            ec = std::error_code(err, std::system_category());
+        }
+    }
+    _pending.erase(_pending.begin(), _pending.begin() + static_cast<std::ptrdiff_t>(n_prepped));
+    _n_in_flight += n_prepped;
+    return n_prepped;
+#else
+    return 0;
+#endif
+}
+
+std::size_t
+uring_engine::reap(std::span<uring_completion> out, std::size_t wait_for, std::error_code& ec) {
+    wait_for = (std::min)({wait_for, out.size(), _n_in_flight});
+
+    std::size_t n_reaped = 0;
+    if (!_ring) {
+        auto n = (std::min)(out.size(), _fallback_done.size());
+        std::copy_n(_fallback_done.begin(), n, out.begin());
+        _fallback_done.erase(_fallback_done.begin(),
+                             _fallback_done.begin() + static_cast<std::ptrdiff_t>(n));
+        _n_in_flight -= n;
+        return n;
+    }
+#if NEO_IO_HAVE_IO_URING
+    auto on_cqe = [&](const ::io_uring_cqe& cqe) {
+        auto                   slot = reinterpret_cast<op_slot*>(cqe.user_data);
+        native_transfer_result res;
+        if (cqe.res < 0) {
+            res.errn = -cqe.res;
+        } else {
+            res.bytes_transferred = static_cast<std::size_t>(cqe.res);
+        }
+        out[n_reaped++] = {slot->user_data, res};
+        _release_op(*slot);
+        --_n_in_flight;
+    };
+    _ring->drain(out.size(), on_cqe);
+    while (n_reaped < wait_for) {
+        auto need = static_cast<unsigned>(wait_for - n_reaped);
+        if (auto err = _ring->enter(need)) {
+            if (err != EINTR) {
+                ec = std::error_code(err, std::system_category());
+                break;
+            }
+        }
+        _ring->drain(out.size() - n_reaped, on_cqe);
+    }
+#endif
+    return n_reaped;
+}
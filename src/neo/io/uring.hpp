@@ -0,0 +1,268 @@
+#pragma once
+
+#include <neo/io/stream/native.hpp>
+#include <neo/io/stream/posix.hpp>
+#include <neo/io/stream/result.hpp>
+
+#include <neo/buffer_range.hpp>
+#include <neo/error.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace neo {
+
+namespace io_detail {
+
+struct uring_ring;
+
+}  // namespace io_detail
+
+/**
+ * @brief The result of a completed operation on a uring_engine.
+ */
+struct uring_completion {
+    /// The user_data that was given when the operation was prepared
+    std::uint64_t user_data = 0;
+    /// The result of the transfer
+    native_transfer_result result;
+};
+
+/**
+ * @brief Control how a uring_engine executes its operations.
+ */
+enum class uring_mode {
+    /// Use io_uring if the system supports it, otherwise use the fallback
+    automatic,
+    /// Always execute operations with readv()/writev() when they are submitted
+    fallback,
+};
+
+/**
+ * @brief Batch read_some()/write_some() operations on native streams and submit
+ * them to the kernel together.
+ *
+ * Operations are prepared against any stream that has a native handle (such as
+ * native_stream, file_stream, and socket), and are then all started with a
+ * single call to submit(). Their completions are collected with reap().
+ *
+ * On Linux with io_uring support, a prepared batch is submitted with a single
+ * system call. Buffers and handles that are used for many operations can be
+ * registered with the kernel to avoid the per-operation cost of mapping them.
+ *
+ * If io_uring is not available (or is older than Linux 5.6, which cannot
+ * use the current file position), the engine falls back to executing each
+ * operation with readv()/writev() when submit() is called. The results are
+ * identical, but there are no syscall savings. Check uses_io_uring().
+ *
+ * The buffers given for an operation must remain valid until the completion of
+ * that operation has been reaped. Like the underlying streams, transfers on
+ * files use (and advance) the current file position.
+ *
+ * A uring_engine is not thread-safe.
+ */
+class uring_engine {
+    enum class op_kind : std::uint8_t {
+        readv,
+        writev,
+        read_fixed,
+        write_fixed,
+    };
+
+    struct op_slot {
+        std::uint64_t                 user_data = 0;
+        native_stream_handle          handle    = native_stream::invalid_native_handle_value;
+        op_kind                       kind      = op_kind::readv;
+        std::uint16_t                 buf_index = 0;
+        op_slot*                      next_free = nullptr;
+        std::vector<posix_iovec_type> iov;
+    };
+
+    /// Storage for each operation. The size is fixed so that slot addresses are stable.
+    std::vector<op_slot> _slots;
+    op_slot*             _free_slots = nullptr;
+    /// Operations that have been prepared but not submitted
+    std::vector<op_slot*> _pending;
+    /// Completions that were produced by the fallback, waiting to be reaped
+    std::vector<uring_completion> _fallback_done;
+    std::size_t                   _n_in_flight = 0;
+
+    /// Map of registered handles to their registration index
+    std::unordered_map<native_stream_handle, unsigned> _registered_handles;
+    /// The buffers registered with register_buffers()
+    std::vector<posix_iovec_type> _registered_buffers;
+
+    std::unique_ptr<io_detail::uring_ring> _ring;
+
+    op_slot* _new_op(op_kind kind, native_stream_handle hndl, std::uint64_t user_data) noexcept;
+
+    static void _push_iov(op_slot& slot, const_buffer buf) {
+        slot.iov.push_back({const_cast<std::byte*>(buf.data()), buf.size()});
+    }
+    static void _push_iov(op_slot& slot, mutable_buffer buf) { _push_iov(slot, const_buffer(buf)); }
+
+    template <buffer_range Bufs>
+    static void _push_iov(op_slot& slot, const Bufs& bufs) {
+        using std::begin;
+        using std::end;
+        auto it   = begin(bufs);
+        auto stop = end(bufs);
+        for (; it != stop; ++it) {
+            _push_iov(slot, const_buffer(*it));
+        }
+    }
+
+    template <typename Stream, typename Bufs>
+    bool _prep_vectored(op_kind kind, Stream& strm, const Bufs& bufs, std::uint64_t user_data) {
+        auto slot = _new_op(kind, native_handle_of(strm), user_data);
+        if (!slot) {
+            return false;
+        }
+        try {
+            _push_iov(*slot, bufs);
+        } catch (...) {
+            _release_op(*slot);
+            throw;
+        }
+        _pending.push_back(slot);
+        return true;
+    }
+
+    bool _prep_fixed(op_kind              kind,
+                     native_stream_handle hndl,
+                     std::size_t          buf_index,
+                     const_buffer         part,
+                     std::uint64_t        user_data);
+
+    void _release_op(op_slot&) noexcept;
+
+    void _submit_fallback() noexcept;
+
+public:
+    /**
+     * @brief Create a new engine that allows up to `queue_depth` operations to
+     * be pending or in-flight at once.
+     *
+     * If io_uring is requested but cannot be initialized, the engine uses the
+     * readv()/writev() fallback.
+     */
+    explicit uring_engine(unsigned queue_depth = 256, uring_mode mode = uring_mode::automatic);
+    ~uring_engine();
+
+    uring_engine(uring_engine&&) noexcept;
+    uring_engine& operator=(uring_engine&&) noexcept;
+
+    /**
+     * @brief Determine whether this engine submits operations using io_uring.
+     */
+    [[nodiscard]] bool uses_io_uring() const noexcept { return _ring != nullptr; }
+
+    /**
+     * @brief Prepare a read_some() of the given stream into the given buffers.
+     *
+     * @param strm A stream with a native handle. Must outlive the operation.
+     * @param bufs The buffers that will receive data. Must outlive the operation.
+     * @param user_data An arbitrary value that identifies the operation in its completion.
+     * @return false if the engine is full, and completions must be reaped first.
+     */
+    template <typename Stream, mutable_buffer_range Bufs>
+    bool prep_read_some(Stream& strm, const Bufs& bufs, std::uint64_t user_data) {
+        return _prep_vectored(op_kind::readv, strm, bufs, user_data);
+    }
+
+    /**
+     * @brief Prepare a write_some() of the given buffers into the given stream.
+     *
+     * @return false if the engine is full, and completions must be reaped first.
+     */
+    template <typename Stream, buffer_range Bufs>
+    bool prep_write_some(Stream& strm, const Bufs& bufs, std::uint64_t user_data) {
+        return _prep_vectored(op_kind::writev, strm, bufs, user_data);
+    }
+
+    /**
+     * @brief Prepare a read into part of a buffer that was registered with register_buffers()
+     *
+     * @param buf_index The index of the registered buffer
+     * @param part The destination of the read. Must lie within the registered buffer.
+     */
+    template <typename Stream>
+    bool prep_read_some_fixed(Stream&        strm,
+                              std::size_t    buf_index,
+                              mutable_buffer part,
+                              std::uint64_t  user_data) {
+        return _prep_fixed(op_kind::read_fixed, native_handle_of(strm), buf_index, part, user_data);
+    }
+
+    /**
+     * @brief Prepare a write from part of a buffer that was registered with register_buffers()
+     */
+    template <typename Stream>
+    bool prep_write_some_fixed(Stream&       strm,
+                               std::size_t   buf_index,
+                               const_buffer  part,
+                               std::uint64_t user_data) {
+        return _prep_fixed(op_kind::write_fixed,
+                           native_handle_of(strm),
+                           buf_index,
+                           part,
+                           user_data);
+    }
+
+    /**
+     * @brief Register buffers with the kernel for use with the `_fixed` operations.
+     *
+     * Replaces any prior registration. May only be called when no operations
+     * are pending or in-flight.
+     */
+    void register_buffers(std::span<const mutable_buffer> bufs, std::error_code& ec);
+    void register_buffers(std::span<const mutable_buffer> bufs) {
+        register_buffers(bufs, "Failed to register buffers with the uring_engine"_ec_throw);
+    }
+
+    /**
+     * @brief Register native handles with the kernel. Operations on these
+     * handles will automatically use the registration.
+     *
+     * Replaces any prior registration. May only be called when no operations
+     * are pending or in-flight.
+     */
+    void register_handles(std::span<const native_stream_handle> handles, std::error_code& ec);
+    void register_handles(std::span<const native_stream_handle> handles) {
+        register_handles(handles, "Failed to register handles with the uring_engine"_ec_throw);
+    }
+
+    /**
+     * @brief Start all prepared operations.
+     *
+     * @return The number of operations that were submitted.
+     */
+    std::size_t submit(std::error_code& ec) noexcept;
+    std::size_t submit() {
+        return submit("Failed to submit operations to the uring_engine"_ec_throw);
+    }
+
+    /**
+     * @brief Collect the results of completed operations.
+     *
+     * @param out Destination for completions.
+     * @param wait_for Wait until at least this many completions are available
+     *      (limited by the size of `out` and the number of in-flight operations).
+     * @return The number of completions that were written to `out`.
+     */
+    std::size_t reap(std::span<uring_completion> out, std::size_t wait_for, std::error_code& ec);
+    std::size_t reap(std::span<uring_completion> out, std::size_t wait_for = 0) {
+        return reap(out, wait_for, "Failed to reap completions from the uring_engine"_ec_throw);
+    }
+
+    /// The number of operations that have been prepared but not submitted
+    [[nodiscard]] std::size_t pending() const noexcept { return _pending.size(); }
+    /// The number of operations that have been submitted but not reaped
+    [[nodiscard]] std::size_t in_flight() const noexcept { return _n_in_flight; }
+};
+
+}  // namespace neo
@@ -0,0 +1,110 @@
+#include <neo/io/uring.hpp>
+
+#include "../../../testing/pipe.hpp"
+
+#include <neo/io/stream/file.hpp>
+
+#include <catch2/catch.hpp>
+
+#if __linux__
+
+#include <array>
+#include <string>
+
+using neo::testing::make_pipe;
+
+TEST_CASE("Batch reads and writes with a uring_engine") {
+    auto mode = GENERATE(neo::uring_mode::automatic, neo::uring_mode::fallback);
+    CAPTURE(int(mode));
+
+    neo::uring_engine eng{8, mode};
+    if (mode == neo::uring_mode::fallback) {
+        CHECK_FALSE(eng.uses_io_uring());
+    }
+
+    auto [in1, out1] = make_pipe();
+    auto [in2, out2] = make_pipe();
+
+    std::array<neo::const_buffer, 2> hello = {
+        neo::const_buffer("Hello, "),
+        neo::const_buffer("world!"),
+    };
+    REQUIRE(eng.prep_write_some(out1, hello, 1));
+    REQUIRE(eng.prep_write_some(out2, neo::const_buffer("Goodbye"), 2));
+    CHECK(eng.pending() == 2);
+    CHECK(eng.submit() == 2);
+    CHECK(eng.pending() == 0);
+
+    std::array<neo::uring_completion, 8> done;
+    auto                                 n_done = eng.reap(done, 2);
+    REQUIRE(n_done == 2);
+    CHECK(eng.in_flight() == 0);
+    for (auto& c : std::span(done.data(), n_done)) {
+        CHECK_FALSE(c.result.has_error());
+        CHECK(c.result.bytes_transferred == (c.user_data == 1 ? 13 : 7));
+    }
+
+    std::string buf1, buf2;
+    buf1.resize(64);
+    buf2.resize(64);
+    REQUIRE(eng.prep_read_some(in1, neo::mutable_buffer(buf1), 3));
+    REQUIRE(eng.prep_read_some(in2, neo::mutable_buffer(buf2), 4));
+    CHECK(eng.submit() == 2);
+    n_done = eng.reap(done, 2);
+    REQUIRE(n_done == 2);
+    for (auto& c : std::span(done.data(), n_done)) {
+        CHECK_FALSE(c.result.has_error());
+        if (c.user_data == 3) {
+            buf1.resize(c.result.bytes_transferred);
+        } else {
+            buf2.resize(c.result.bytes_transferred);
+        }
+    }
+    CHECK(buf1 == "Hello, world!");
+    CHECK(buf2 == "Goodbye");
+}
+
+TEST_CASE("Registered buffers and handles") {
+    auto mode = GENERATE(neo::uring_mode::automatic, neo::uring_mode::fallback);
+    CAPTURE(int(mode));
+
+    neo::uring_engine eng{4, mode};
+
+    neo::file_stream file{"uring-test.txt", neo::open_mode::write};
+    std::string      storage = "Registered data";
+
+    std::array<neo::mutable_buffer, 1> bufs = {neo::mutable_buffer(storage)};
+    eng.register_buffers(bufs);
+    std::array<neo::native_stream_handle, 1> handles = {neo::native_handle_of(file)};
+    eng.register_handles(handles);
+
+    REQUIRE(eng.prep_write_some_fixed(file, 0, neo::const_buffer(bufs[0]), 42));
+    CHECK(eng.submit() == 1);
+    std::array<neo::uring_completion, 1> done;
+    REQUIRE(eng.reap(done, 1) == 1);
+    CHECK(done[0].user_data == 42);
+    CHECK_FALSE(done[0].result.has_error());
+    CHECK(done[0].result.bytes_transferred == storage.size());
+    file.close();
+
+    file = neo::file_stream::open("uring-test.txt");
+    std::string rbuf;
+    rbuf.resize(64);
+    auto res = file.read_some(neo::mutable_buffer(rbuf));
+    rbuf.resize(res.bytes_transferred);
+    CHECK(rbuf == storage);
+}
+
+TEST_CASE("A full uring_engine refuses new operations") {
+    neo::uring_engine eng{2, neo::uring_mode::fallback};
+    auto [in, out] = make_pipe();
+    CHECK(eng.prep_write_some(out, neo::const_buffer("a"), 1));
+    CHECK(eng.prep_write_some(out, neo::const_buffer("b"), 2));
+    CHECK_FALSE(eng.prep_write_some(out, neo::const_buffer("c"), 3));
+    eng.submit();
+    std::array<neo::uring_completion, 2> done;
+    CHECK(eng.reap(done) == 2);
+    CHECK(eng.prep_write_some(out, neo::const_buffer("c"), 3));
+}
+
+#endif
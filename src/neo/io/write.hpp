@@ -7,6 +7,8 @@
 
 #include <neo/const_buffer.hpp>
 
+#include <cstdint>
+
 namespace neo {
 
 /**
@@ -48,4 +50,37 @@ write_result_t<Stream> write(Stream& strm, const Bufs& b) noexcept {
     return write(strm, b, transfer_all);
 }
 
+/**
+ * Write data from the given buffers into the given stream, beginning at the
+ * given offset, until the completion condition returns zero or we exhaust the
+ * buffer sequence. The stream position (if any) is not used.
+ *
+ * The completion condition behaves as with write().
+ */
+template <random_access_write_stream                Stream,
+          buffer_range                              Bufs,
+          write_at_completion_condition_for<Stream> CompletionCondition>
+write_at_result_t<Stream> write_at(Stream&               strm,
+                                   std::uint64_t         offset,
+                                   const Bufs&           bufs,
+                                   CompletionCondition&& cond) noexcept {
+    auto use_buf_ranges = std::bool_constant<vectored_random_access_write_stream<Stream>>{};
+    return detail::do_io_op(bufs, cond, use_buf_ranges, [&](auto&& bufs) {
+        auto res = strm.write_some_at(offset, bufs);
+        offset += res.bytes_transferred;
+        return res;
+    });
+}
+
+/**
+ * Write the entire contents of the given buffer into the given stream at the
+ * given offset.
+ *
+ * Equivalent to: write_at(strm, offset, b, transfer_all)
+ */
+template <random_access_write_stream Stream, buffer_range Bufs>
+write_at_result_t<Stream> write_at(Stream& strm, std::uint64_t offset, const Bufs& b) noexcept {
+    return write_at(strm, offset, b, transfer_all);
+}
+
 }  // namespace neo
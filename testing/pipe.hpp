@@ -0,0 +1,30 @@
+#pragma once
+
+#include <neo/io/stream/native.hpp>
+
+#include <neo/platform.hpp>
+
+#include <catch2/catch.hpp>
+
+#if NEO_OS_IS_UNIX_LIKE
+
+#include <unistd.h>
+
+#include <utility>
+
+namespace neo::testing {
+
+/**
+ * Create an anonymous pipe. Returns the reading and writing ends, both in
+ * blocking mode.
+ */
+inline std::pair<native_stream, native_stream> make_pipe() {
+    int fds[2] = {};
+    REQUIRE(::pipe(fds) == 0);
+    return {native_stream::from_native_handle(std::move(fds[0])),
+            native_stream::from_native_handle(std::move(fds[1]))};
+}
+
+}  // namespace neo::testing
+
+#endif
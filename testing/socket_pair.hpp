@@ -0,0 +1,29 @@
+#pragma once
+
+#include <neo/io/stream/listener.hpp>
+#include <neo/io/stream/socket.hpp>
+
+#include <utility>
+
+namespace neo::testing {
+
+/**
+ * Accept a connection on the listener, and place it in blocking mode.
+ */
+inline socket accept_blocking(listener& lis) {
+    auto server = lis.accept();
+    server.set_nonblocking(false);
+    return server;
+}
+
+/**
+ * Connect a client socket to the listener, and accept the connection. Returns
+ * the client and server ends, both in blocking mode.
+ */
+inline std::pair<socket, socket> make_socket_pair(listener& lis) {
+    auto client = socket::open_connected(lis.local_address(), socket::type::stream);
+    auto server = accept_blocking(lis);
+    return {std::move(client), std::move(server)};
+}
+
+}  // namespace neo::testing